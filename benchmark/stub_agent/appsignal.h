@@ -0,0 +1,99 @@
+// Header of the stub AppSignal agent library used by the benchmark suite.
+//
+// It declares the subset of the AppSignal agent library API that the C
+// extension in `ext/appsignal_extension.c` calls, with the same signatures, so
+// the extension can be built and benchmarked without downloading the agent.
+// See `appsignal_stub.c` for the implementation.
+//
+// `appsignal_add_transaction_error` is the exception: the released agent
+// library doesn't provide it yet. `ext/extconf.rb` checks for it with
+// `have_func`, so against the released agent the extension's `add_error` path
+// is compiled out and additional errors are reported as duplicate
+// transactions. Only builds against this stub exercise that path.
+
+#ifndef APPSIGNAL_STUB_H
+#define APPSIGNAL_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+  size_t len;
+  const char* buf;
+} appsignal_string_t;
+
+typedef struct appsignal_transaction_t appsignal_transaction_t;
+typedef struct appsignal_data_t appsignal_data_t;
+typedef struct appsignal_span_t appsignal_span_t;
+
+// Starting and stopping
+void appsignal_start(void);
+void appsignal_stop(void);
+appsignal_string_t appsignal_diagnose(void);
+appsignal_string_t appsignal_get_server_state(appsignal_string_t key);
+int appsignal_running_in_container(void);
+void appsignal_set_environment_metadata(appsignal_string_t key, appsignal_string_t value);
+void appsignal_track_allocation(void);
+
+// Transactions
+appsignal_transaction_t* appsignal_start_transaction(appsignal_string_t transaction_id, appsignal_string_t namespace, long gc_duration_ms);
+void appsignal_start_event(appsignal_transaction_t* transaction, long gc_duration_ms);
+void appsignal_finish_event(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t title, appsignal_string_t body, int body_format, long gc_duration_ms);
+void appsignal_finish_event_data(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t title, appsignal_data_t* body, int body_format, long gc_duration_ms);
+void appsignal_record_event(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t title, appsignal_string_t body, int body_format, long duration, long gc_duration_ms);
+void appsignal_record_event_data(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t title, appsignal_data_t* body, int body_format, long duration, long gc_duration_ms);
+void appsignal_set_transaction_error(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t message, appsignal_data_t* backtrace);
+void appsignal_add_transaction_error(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t message, appsignal_data_t* backtrace, appsignal_data_t* causes);
+void appsignal_set_transaction_sample_data(appsignal_transaction_t* transaction, appsignal_string_t key, appsignal_data_t* payload);
+void appsignal_set_transaction_action(appsignal_transaction_t* transaction, appsignal_string_t action);
+void appsignal_set_transaction_namespace(appsignal_transaction_t* transaction, appsignal_string_t namespace);
+void appsignal_set_transaction_queue_start(appsignal_transaction_t* transaction, long queue_start);
+void appsignal_set_transaction_metadata(appsignal_transaction_t* transaction, appsignal_string_t key, appsignal_string_t value);
+int appsignal_finish_transaction(appsignal_transaction_t* transaction, long gc_duration_ms);
+appsignal_transaction_t* appsignal_duplicate_transaction(appsignal_transaction_t* transaction, appsignal_string_t new_transaction_id);
+void appsignal_complete_transaction(appsignal_transaction_t* transaction);
+appsignal_string_t appsignal_transaction_to_json(appsignal_transaction_t* transaction);
+void appsignal_free_transaction(void* transaction);
+
+// Data
+appsignal_data_t* appsignal_data_map_new(void);
+appsignal_data_t* appsignal_data_array_new(void);
+void appsignal_data_map_set_string(appsignal_data_t* data, appsignal_string_t key, appsignal_string_t value);
+void appsignal_data_map_set_integer(appsignal_data_t* data, appsignal_string_t key, long value);
+void appsignal_data_map_set_float(appsignal_data_t* data, appsignal_string_t key, double value);
+void appsignal_data_map_set_boolean(appsignal_data_t* data, appsignal_string_t key, int value);
+void appsignal_data_map_set_null(appsignal_data_t* data, appsignal_string_t key);
+void appsignal_data_map_set_data(appsignal_data_t* data, appsignal_string_t key, appsignal_data_t* value);
+void appsignal_data_array_append_string(appsignal_data_t* data, appsignal_string_t value);
+void appsignal_data_array_append_integer(appsignal_data_t* data, long value);
+void appsignal_data_array_append_float(appsignal_data_t* data, double value);
+void appsignal_data_array_append_boolean(appsignal_data_t* data, int value);
+void appsignal_data_array_append_null(appsignal_data_t* data);
+void appsignal_data_array_append_data(appsignal_data_t* data, appsignal_data_t* value);
+int appsignal_data_equal(appsignal_data_t* data, appsignal_data_t* other);
+appsignal_string_t appsignal_data_to_json(appsignal_data_t* data);
+void appsignal_free_data(void* data);
+
+// Spans
+appsignal_span_t* appsignal_create_root_span(appsignal_string_t namespace);
+appsignal_span_t* appsignal_create_child_span(appsignal_span_t* parent);
+void appsignal_set_span_name(appsignal_span_t* span, appsignal_string_t name);
+void appsignal_add_span_error(appsignal_span_t* span, appsignal_string_t name, appsignal_string_t message, appsignal_data_t* backtrace);
+void appsignal_set_span_sample_data(appsignal_span_t* span, appsignal_string_t key, appsignal_data_t* payload);
+void appsignal_set_span_attribute_string(appsignal_span_t* span, appsignal_string_t key, appsignal_string_t value);
+void appsignal_set_span_attribute_int(appsignal_span_t* span, appsignal_string_t key, int64_t value);
+void appsignal_set_span_attribute_bool(appsignal_span_t* span, appsignal_string_t key, int value);
+void appsignal_set_span_attribute_double(appsignal_span_t* span, appsignal_string_t key, double value);
+appsignal_string_t appsignal_span_to_json(appsignal_span_t* span);
+void appsignal_close_span(appsignal_span_t* span);
+void appsignal_free_span(void* span);
+
+// Logging
+void appsignal_log(appsignal_string_t group, int severity, int format, appsignal_string_t message, appsignal_data_t* attributes);
+
+// Metrics
+void appsignal_set_gauge(appsignal_string_t key, double value, appsignal_data_t* tags);
+void appsignal_increment_counter(appsignal_string_t key, double count, appsignal_data_t* tags);
+void appsignal_add_distribution_value(appsignal_string_t key, double value, appsignal_data_t* tags);
+
+#endif
@@ -0,0 +1,383 @@
+// Stub of the AppSignal agent library, for the benchmark suite.
+//
+// Implements `appsignal.h` without an agent to report to: transactions, spans,
+// logs and metrics are accepted and dropped. `Data` objects are serialized to
+// JSON as they are built, so building them costs about as much as it does in
+// the real library.
+//
+// Every call that would cross into the agent waits for the number of
+// nanoseconds set in the `APPSIGNAL_STUB_LATENCY_NS` environment variable,
+// which is read on the first call. It defaults to 0, no latency. The wait is
+// a busy wait, like the work the real library does on the calling thread.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "appsignal.h"
+
+struct appsignal_data_t {
+  int is_array;
+  size_t count;
+  char* buf;
+  size_t len;
+  size_t cap;
+  char* json;
+};
+
+struct appsignal_transaction_t {
+  size_t events;
+  size_t errors;
+  size_t sample_data;
+  int completed;
+  char* json;
+};
+
+struct appsignal_span_t {
+  size_t attributes;
+  int closed;
+};
+
+static long latency_ns = -1;
+
+static void stub_latency(void) {
+  struct timespec start, now;
+  long elapsed;
+
+  if (latency_ns < 0) {
+    const char* value = getenv("APPSIGNAL_STUB_LATENCY_NS");
+    latency_ns = value ? atol(value) : 0;
+  }
+  if (latency_ns <= 0) {
+    return;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  do {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec);
+  } while (elapsed < latency_ns);
+}
+
+static const appsignal_string_t empty_string = { .len = 0, .buf = "" };
+
+// Starting and stopping
+
+void appsignal_start(void) { stub_latency(); }
+void appsignal_stop(void) {}
+
+appsignal_string_t appsignal_diagnose(void) {
+  static const char report[] = "{\"stub\":true}";
+  return (appsignal_string_t) { .len = sizeof(report) - 1, .buf = report };
+}
+
+appsignal_string_t appsignal_get_server_state(appsignal_string_t key) {
+  return empty_string;
+}
+
+int appsignal_running_in_container(void) { return 0; }
+void appsignal_set_environment_metadata(appsignal_string_t key, appsignal_string_t value) {}
+void appsignal_track_allocation(void) {}
+
+// Data
+
+static void data_reserve(appsignal_data_t* data, size_t extra) {
+  if (data->len + extra <= data->cap) {
+    return;
+  }
+  while (data->len + extra > data->cap) {
+    data->cap = data->cap ? data->cap * 2 : 64;
+  }
+  data->buf = realloc(data->buf, data->cap);
+}
+
+static void data_write(appsignal_data_t* data, const char* buf, size_t len) {
+  data_reserve(data, len);
+  memcpy(data->buf + data->len, buf, len);
+  data->len += len;
+}
+
+static void data_write_string(appsignal_data_t* data, appsignal_string_t string) {
+  size_t i;
+
+  data_reserve(data, string.len * 2 + 2);
+  data->buf[data->len++] = '"';
+  for (i = 0; i < string.len; i++) {
+    char c = string.buf[i];
+    if (c == '"' || c == '\\') {
+      data->buf[data->len++] = '\\';
+    }
+    data->buf[data->len++] = c;
+  }
+  data->buf[data->len++] = '"';
+}
+
+// Writes the separator and, for maps, the key of the next entry.
+static void data_next(appsignal_data_t* data, appsignal_string_t* key) {
+  if (data->count++ > 0) {
+    data_write(data, ",", 1);
+  }
+  if (key) {
+    data_write_string(data, *key);
+    data_write(data, ":", 1);
+  }
+}
+
+static void data_write_integer(appsignal_data_t* data, long value) {
+  char buf[32];
+  data_write(data, buf, snprintf(buf, sizeof(buf), "%ld", value));
+}
+
+static void data_write_float(appsignal_data_t* data, double value) {
+  char buf[32];
+  data_write(data, buf, snprintf(buf, sizeof(buf), "%g", value));
+}
+
+static appsignal_data_t* data_new(int is_array) {
+  appsignal_data_t* data = calloc(1, sizeof(appsignal_data_t));
+  data->is_array = is_array;
+  return data;
+}
+
+appsignal_data_t* appsignal_data_map_new(void) { return data_new(0); }
+appsignal_data_t* appsignal_data_array_new(void) { return data_new(1); }
+
+void appsignal_data_map_set_string(appsignal_data_t* data, appsignal_string_t key, appsignal_string_t value) {
+  data_next(data, &key);
+  data_write_string(data, value);
+}
+
+void appsignal_data_map_set_integer(appsignal_data_t* data, appsignal_string_t key, long value) {
+  data_next(data, &key);
+  data_write_integer(data, value);
+}
+
+void appsignal_data_map_set_float(appsignal_data_t* data, appsignal_string_t key, double value) {
+  data_next(data, &key);
+  data_write_float(data, value);
+}
+
+void appsignal_data_map_set_boolean(appsignal_data_t* data, appsignal_string_t key, int value) {
+  data_next(data, &key);
+  data_write(data, value ? "true" : "false", value ? 4 : 5);
+}
+
+void appsignal_data_map_set_null(appsignal_data_t* data, appsignal_string_t key) {
+  data_next(data, &key);
+  data_write(data, "null", 4);
+}
+
+void appsignal_data_map_set_data(appsignal_data_t* data, appsignal_string_t key, appsignal_data_t* value) {
+  appsignal_string_t json = appsignal_data_to_json(value);
+  data_next(data, &key);
+  data_write(data, json.buf, json.len);
+}
+
+void appsignal_data_array_append_string(appsignal_data_t* data, appsignal_string_t value) {
+  data_next(data, NULL);
+  data_write_string(data, value);
+}
+
+void appsignal_data_array_append_integer(appsignal_data_t* data, long value) {
+  data_next(data, NULL);
+  data_write_integer(data, value);
+}
+
+void appsignal_data_array_append_float(appsignal_data_t* data, double value) {
+  data_next(data, NULL);
+  data_write_float(data, value);
+}
+
+void appsignal_data_array_append_boolean(appsignal_data_t* data, int value) {
+  data_next(data, NULL);
+  data_write(data, value ? "true" : "false", value ? 4 : 5);
+}
+
+void appsignal_data_array_append_null(appsignal_data_t* data) {
+  data_next(data, NULL);
+  data_write(data, "null", 4);
+}
+
+void appsignal_data_array_append_data(appsignal_data_t* data, appsignal_data_t* value) {
+  appsignal_string_t json = appsignal_data_to_json(value);
+  data_next(data, NULL);
+  data_write(data, json.buf, json.len);
+}
+
+int appsignal_data_equal(appsignal_data_t* data, appsignal_data_t* other) {
+  return data->is_array == other->is_array &&
+    data->len == other->len &&
+    memcmp(data->buf, other->buf, data->len) == 0;
+}
+
+appsignal_string_t appsignal_data_to_json(appsignal_data_t* data) {
+  free(data->json);
+  data->json = malloc(data->len + 2);
+  data->json[0] = data->is_array ? '[' : '{';
+  if (data->len > 0) {
+    memcpy(data->json + 1, data->buf, data->len);
+  }
+  data->json[data->len + 1] = data->is_array ? ']' : '}';
+  return (appsignal_string_t) { .len = data->len + 2, .buf = data->json };
+}
+
+void appsignal_free_data(void* pointer) {
+  appsignal_data_t* data = pointer;
+  free(data->buf);
+  free(data->json);
+  free(data);
+}
+
+// Transactions
+
+appsignal_transaction_t* appsignal_start_transaction(appsignal_string_t transaction_id, appsignal_string_t namespace, long gc_duration_ms) {
+  stub_latency();
+  return calloc(1, sizeof(appsignal_transaction_t));
+}
+
+void appsignal_start_event(appsignal_transaction_t* transaction, long gc_duration_ms) {
+  stub_latency();
+}
+
+void appsignal_finish_event(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t title, appsignal_string_t body, int body_format, long gc_duration_ms) {
+  stub_latency();
+  transaction->events++;
+}
+
+void appsignal_finish_event_data(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t title, appsignal_data_t* body, int body_format, long gc_duration_ms) {
+  stub_latency();
+  transaction->events++;
+}
+
+void appsignal_record_event(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t title, appsignal_string_t body, int body_format, long duration, long gc_duration_ms) {
+  stub_latency();
+  transaction->events++;
+}
+
+void appsignal_record_event_data(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t title, appsignal_data_t* body, int body_format, long duration, long gc_duration_ms) {
+  stub_latency();
+  transaction->events++;
+}
+
+void appsignal_set_transaction_error(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t message, appsignal_data_t* backtrace) {
+  stub_latency();
+  transaction->errors = 1;
+}
+
+void appsignal_add_transaction_error(appsignal_transaction_t* transaction, appsignal_string_t name, appsignal_string_t message, appsignal_data_t* backtrace, appsignal_data_t* causes) {
+  stub_latency();
+  transaction->errors++;
+}
+
+void appsignal_set_transaction_sample_data(appsignal_transaction_t* transaction, appsignal_string_t key, appsignal_data_t* payload) {
+  stub_latency();
+  transaction->sample_data++;
+}
+
+void appsignal_set_transaction_action(appsignal_transaction_t* transaction, appsignal_string_t action) { stub_latency(); }
+void appsignal_set_transaction_namespace(appsignal_transaction_t* transaction, appsignal_string_t namespace) { stub_latency(); }
+void appsignal_set_transaction_queue_start(appsignal_transaction_t* transaction, long queue_start) { stub_latency(); }
+void appsignal_set_transaction_metadata(appsignal_transaction_t* transaction, appsignal_string_t key, appsignal_string_t value) { stub_latency(); }
+
+int appsignal_finish_transaction(appsignal_transaction_t* transaction, long gc_duration_ms) {
+  stub_latency();
+  return 1;
+}
+
+appsignal_transaction_t* appsignal_duplicate_transaction(appsignal_transaction_t* transaction, appsignal_string_t new_transaction_id) {
+  appsignal_transaction_t* duplicate = malloc(sizeof(appsignal_transaction_t));
+
+  stub_latency();
+  memcpy(duplicate, transaction, sizeof(appsignal_transaction_t));
+  duplicate->json = NULL;
+  return duplicate;
+}
+
+void appsignal_complete_transaction(appsignal_transaction_t* transaction) {
+  stub_latency();
+  transaction->completed = 1;
+}
+
+appsignal_string_t appsignal_transaction_to_json(appsignal_transaction_t* transaction) {
+  char buf[128];
+  int len = snprintf(
+    buf,
+    sizeof(buf),
+    "{\"events\":%zu,\"errors\":%zu,\"sample_data\":%zu}",
+    transaction->events,
+    transaction->errors,
+    transaction->sample_data
+  );
+
+  free(transaction->json);
+  transaction->json = strdup(buf);
+  return (appsignal_string_t) { .len = len, .buf = transaction->json };
+}
+
+void appsignal_free_transaction(void* pointer) {
+  appsignal_transaction_t* transaction = pointer;
+  free(transaction->json);
+  free(transaction);
+}
+
+// Spans
+
+appsignal_span_t* appsignal_create_root_span(appsignal_string_t namespace) {
+  stub_latency();
+  return calloc(1, sizeof(appsignal_span_t));
+}
+
+appsignal_span_t* appsignal_create_child_span(appsignal_span_t* parent) {
+  stub_latency();
+  return calloc(1, sizeof(appsignal_span_t));
+}
+
+void appsignal_set_span_name(appsignal_span_t* span, appsignal_string_t name) { stub_latency(); }
+void appsignal_add_span_error(appsignal_span_t* span, appsignal_string_t name, appsignal_string_t message, appsignal_data_t* backtrace) { stub_latency(); }
+void appsignal_set_span_sample_data(appsignal_span_t* span, appsignal_string_t key, appsignal_data_t* payload) { stub_latency(); }
+
+void appsignal_set_span_attribute_string(appsignal_span_t* span, appsignal_string_t key, appsignal_string_t value) {
+  stub_latency();
+  span->attributes++;
+}
+
+void appsignal_set_span_attribute_int(appsignal_span_t* span, appsignal_string_t key, int64_t value) {
+  stub_latency();
+  span->attributes++;
+}
+
+void appsignal_set_span_attribute_bool(appsignal_span_t* span, appsignal_string_t key, int value) {
+  stub_latency();
+  span->attributes++;
+}
+
+void appsignal_set_span_attribute_double(appsignal_span_t* span, appsignal_string_t key, double value) {
+  stub_latency();
+  span->attributes++;
+}
+
+appsignal_string_t appsignal_span_to_json(appsignal_span_t* span) {
+  static const char json[] = "{}";
+  return (appsignal_string_t) { .len = sizeof(json) - 1, .buf = json };
+}
+
+void appsignal_close_span(appsignal_span_t* span) {
+  stub_latency();
+  span->closed = 1;
+}
+
+void appsignal_free_span(void* span) {
+  free(span);
+}
+
+// Logging
+
+void appsignal_log(appsignal_string_t group, int severity, int format, appsignal_string_t message, appsignal_data_t* attributes) {
+  stub_latency();
+}
+
+// Metrics
+
+void appsignal_set_gauge(appsignal_string_t key, double value, appsignal_data_t* tags) { stub_latency(); }
+void appsignal_increment_counter(appsignal_string_t key, double count, appsignal_data_t* tags) { stub_latency(); }
+void appsignal_add_distribution_value(appsignal_string_t key, double value, appsignal_data_t* tags) { stub_latency(); }
@@ -0,0 +1,54 @@
+# frozen_string_literal: true
+
+# Builds the C extension against the stub agent library, see `appsignal.h` in
+# this directory. The extension is built in `benchmark/tmp/stub_agent` and
+# loaded from there by the benchmark suite when `APPSIGNAL_STUB_AGENT` is set.
+#
+# Run using: rake --rakefile benchmark.rake benchmark:stub_agent
+
+require "fileutils"
+require "rbconfig"
+
+module StubAgent
+  SOURCE_PATH = File.expand_path(__dir__)
+  EXT_SOURCE_PATH = File.expand_path("../../ext", __dir__)
+  BUILD_PATH = File.expand_path("../tmp/stub_agent", __dir__)
+
+  EXTCONF = <<~RUBY
+    require "mkmf"
+
+    $CFLAGS += " -O2"
+    # The stub implements all optional agent functions. It is compiled into
+    # the extension, so `have_func` can't link against it to check for them.
+    $defs << "-DHAVE_APPSIGNAL_ADD_TRANSACTION_ERROR"
+    create_makefile("appsignal_extension")
+  RUBY
+
+  module_function
+
+  def build
+    FileUtils.rm_rf(BUILD_PATH)
+    FileUtils.mkdir_p(BUILD_PATH)
+    FileUtils.cp(File.join(EXT_SOURCE_PATH, "appsignal_extension.c"), BUILD_PATH)
+    FileUtils.cp(File.join(SOURCE_PATH, "appsignal.h"), BUILD_PATH)
+    FileUtils.cp(File.join(SOURCE_PATH, "appsignal_stub.c"), BUILD_PATH)
+    File.write(File.join(BUILD_PATH, "extconf.rb"), EXTCONF)
+
+    Dir.chdir(BUILD_PATH) do
+      run(RbConfig.ruby, "extconf.rb")
+      run("make")
+    end
+  end
+
+  def built?
+    Dir[File.join(BUILD_PATH, "appsignal_extension.{so,bundle}")].any?
+  end
+
+  def run(*command)
+    return if system(*command, :out => File::NULL)
+
+    abort "Building the stub agent failed: `#{command.join(" ")}` in #{BUILD_PATH}"
+  end
+end
+
+StubAgent.build if $PROGRAM_NAME == __FILE__
@@ -0,0 +1,25 @@
+# frozen_string_literal: true
+
+# Measures the duration and allocations of `Appsignal.start` in a new process,
+# and prints them as JSON. Run by the `benchmark:boot` task, which runs it
+# multiple times with and without the `enable_lazy_hooks` config option.
+
+require "json"
+require "appsignal"
+
+Appsignal.configure(:production) do |config|
+  config.active = true
+  config.push_api_key = "benchmark"
+  config.endpoint = "http://localhost:8080"
+end
+
+allocations_before = GC.stat(:total_allocated_objects)
+started_at = Process.clock_gettime(Process::CLOCK_MONOTONIC, :nanosecond)
+Appsignal.start
+duration = Process.clock_gettime(Process::CLOCK_MONOTONIC, :nanosecond) - started_at
+allocations = GC.stat(:total_allocated_objects) - allocations_before
+
+puts JSON.generate(
+  "duration_ms" => duration / 1_000_000.0,
+  "allocations" => allocations
+)
@@ -0,0 +1,290 @@
+# frozen_string_literal: true
+
+# Benchmark cases per subsystem. See `runner.rb` for how they're measured.
+#
+# Every case block is one operation. Cases that need a transaction create and
+# complete their own, so they can run on multiple threads at once.
+
+begin
+  require "opentelemetry/sdk"
+  # No exporter is configured, so the spans are dropped when they end
+  OpenTelemetry::SDK.configure
+rescue LoadError
+  # The OpenTelemetry backend case is skipped below
+end
+
+module AppsignalBenchmark
+  PARAMS = {
+    "user" => {
+      "name" => "Jane Doe",
+      "email" => "jane@example.com",
+      "password" => "secret",
+      "roles" => ["admin", "editor"],
+      "address" => { "street" => "Main street 1", "city" => "Amsterdam" }
+    },
+    "page" => 2,
+    "per_page" => 50,
+    "active" => true,
+    "ids" => (1..20).to_a
+  }.freeze
+  FILTER_KEYS = ["password", "email"].freeze
+  SQL = "SELECT `users`.* FROM `users` WHERE `users`.`id` = ? LIMIT 1"
+  BACKTRACE = Array.new(30) { |i| "app/models/user.rb:#{i + 1}:in `method_#{i}'" }.freeze
+
+  class BenchmarkError < StandardError; end
+
+  def self.error
+    BenchmarkError.new("Something went wrong").tap { |e| e.set_backtrace(BACKTRACE) }
+  end
+
+  def self.with_transaction(backend = nil)
+    transaction = Appsignal::Transaction.new(
+      Appsignal::Transaction::HTTP_REQUEST,
+      :backend => backend
+    )
+    Appsignal::Transaction.set_current_transaction(transaction)
+    transaction.set_action("UsersController#show")
+    yield transaction
+  ensure
+    Appsignal::Transaction.complete_current!
+  end
+
+  def self.monitor_transaction(backend = nil)
+    with_transaction(backend) do |transaction|
+      transaction.add_params(PARAMS)
+      transaction.add_tags(:user_id => 1)
+      Appsignal.instrument("process_action.action_controller") do
+        5.times { Appsignal.instrument_sql("sql.active_record", nil, SQL) }
+        Appsignal.instrument("render_template.action_view", "users/show.html.erb") do
+          3.times { Appsignal.instrument("cache.read") }
+        end
+      end
+    end
+  end
+
+  # Data
+
+  bench("data/generate params") do
+    Appsignal::Utils::Data.generate(PARAMS)
+  end
+
+  bench("data/generate params with budget") do
+    Appsignal::Utils::Data.generate(
+      PARAMS,
+      Appsignal::Utils::Data::Budget.new(
+        Appsignal::Transaction::SAMPLE_DATA_KEY_BYTES_LIMIT,
+        Appsignal::Transaction::SAMPLE_DATA_DEPTH_LIMIT
+      )
+    )
+  end
+
+  # Sample data
+
+  bench("sample_data/100 add_custom_data per transaction") do
+    with_transaction do |transaction|
+      100.times { |i| transaction.add_custom_data("key_#{i}" => i) }
+    end
+  end
+
+  # Sanitizers
+
+  bench("sanitizer/sample data") do
+    Appsignal::Utils::SampleDataSanitizer.sanitize(PARAMS, FILTER_KEYS)
+  end
+
+  bench("sanitizer/query params") do
+    Appsignal::Utils::QueryParamsSanitizer.sanitize(PARAMS)
+  end
+
+  # Query sanitizers, run on every MongoDB and Elasticsearch query. Every
+  # iteration has different values, but the same shape.
+
+  require "appsignal/event_formatter/mongo_ruby_driver/query_formatter"
+  bench("sanitizer/mongodb find query") do |i|
+    Appsignal::EventFormatter::MongoRubyDriver::QueryFormatter.format(
+      "find",
+      "find" => "users",
+      "filter" => {
+        "account_id" => i,
+        "status" => { "$in" => ["active", "invited"] },
+        "profile.age" => { "$gte" => 18, "$lt" => 65 },
+        "$or" => [{ "email" => "user#{i}@example.com" }, { "username" => "user#{i}" }]
+      }
+    )
+  end
+
+  bench("sanitizer/elasticsearch search query") do |i|
+    Appsignal::Utils::QueryParamsSanitizer.sanitize(
+      "query" => {
+        "bool" => {
+          "must" => [{ "match" => { "title" => "search #{i}" } }],
+          "filter" => [
+            { "term" => { "status" => "published" } },
+            { "range" => { "published_at" => { "gte" => "now-1d" } } }
+          ]
+        }
+      },
+      "size" => 20,
+      "from" => i
+    )
+  end
+
+  # Event formatters
+
+  bench("event_formatter/sql.active_record") do
+    Appsignal::EventFormatter.format(
+      "sql.active_record",
+      :name => "User Load",
+      :sql => SQL
+    )
+  end
+
+  bench("event_formatter/unregistered event") do
+    Appsignal::EventFormatter.format("cache.read", :key => "users/1")
+  end
+
+  # ActiveSupport::Notifications events
+
+  require "appsignal/integrations/active_support_notifications"
+  notifications = Appsignal::Integrations::ActiveSupportNotificationsIntegration
+  sql_payload = { :name => "User Load", :sql => SQL }.freeze
+
+  bench("active_support_notifications/event without transaction") do
+    notifications.start_event("sql.active_record")
+    notifications.finish_event("sql.active_record", sql_payload)
+  end
+
+  bench("active_support_notifications/10 events per transaction") do
+    with_transaction do
+      10.times do
+        notifications.start_event("sql.active_record")
+        notifications.finish_event("sql.active_record", sql_payload)
+      end
+    end
+  end
+
+  # Logger
+
+  logger = Appsignal::Logger.new("benchmark")
+  bench("logger/info") do
+    logger.info("User signed in", :user_id => 1)
+  end
+
+  # Metrics
+
+  bench("metrics/increment_counter") do
+    Appsignal.increment_counter("signups", 1, :plan => "pro")
+  end
+
+  bench("metrics/add_distribution_value") do
+    Appsignal.add_distribution_value("response_size", 1024, :format => "json")
+  end
+
+  # Compare this case to `metrics/add_distribution_value` to see the cost per
+  # transaction of the action histograms over a distribution value per
+  # transaction.
+  if Appsignal::Extension.respond_to?(:record_action_duration)
+    bench("metrics/record action duration") do |i|
+      Appsignal::Extension.record_action_duration(
+        Appsignal::Transaction::HTTP_REQUEST,
+        "UsersController#show",
+        i * 1000
+      )
+    end
+  end
+
+  # Breadcrumbs
+
+  bench("breadcrumbs/10 per transaction") do
+    with_transaction do
+      10.times do |i|
+        Appsignal.add_breadcrumb("network", "GET", "/users/#{i}", :status => 200)
+      end
+    end
+  end
+
+  # Error reporting
+
+  bench("errors/report_error") do
+    Appsignal.report_error(error)
+  end
+
+  bench("errors/3 errors per transaction") do
+    with_transaction do |transaction|
+      3.times { transaction.add_error(error) }
+    end
+  end
+
+  # Spans
+
+  require "appsignal/span"
+
+  span_attributes = Array.new(20) { |i| ["attribute_#{i}", i.even? ? "value" : i] }.to_h.freeze
+  root_span = Appsignal::Span.new("web")
+
+  # Compare these cases to see the overhead of one extension call per
+  # attribute.
+  bench("span/20 attributes with []=") do
+    span = root_span.child
+    span.name = "child"
+    span_attributes.each { |key, value| span[key] = value }
+    span.close
+  end
+
+  bench("span/20 attributes with set_attributes") do
+    span = root_span.child
+    span.name = "child"
+    span.set_attributes(span_attributes)
+    span.close
+  end
+
+  bench("span/20 attributes with child_with") do
+    root_span.child_with("child", span_attributes).close
+  end
+
+  # Rack response bodies
+
+  class StreamedBody
+    CHUNKS = Array.new(100) { "x" * 64 }.freeze
+
+    def each(&block)
+      CHUNKS.each(&block)
+    end
+  end
+
+  # Compare these two cases to see the per chunk overhead of the streaming
+  # instrumentation, divide the difference by 100.
+  [false, true].each do |instrument_streaming|
+    name = "rack/each 100 chunks"
+    name += " with streaming instrumentation" if instrument_streaming
+    bench(name) do
+      with_transaction do |transaction|
+        Appsignal::Rack::EnumerableBodyWrapper.new(
+          StreamedBody.new,
+          transaction,
+          :instrument_streaming => instrument_streaming
+        ).each { |_chunk| nil }
+      end
+    end
+  end
+
+  # Transaction backends
+
+  bench("transaction/extension backend") do
+    monitor_transaction
+  end
+
+  if defined?(::OpenTelemetry::SDK)
+    bench("transaction/opentelemetry backend") do |i|
+      monitor_transaction(
+        Appsignal::Transaction::OpenTelemetryBackend.new(
+          "benchmark-#{i}",
+          Appsignal::Transaction::HTTP_REQUEST
+        )
+      )
+    end
+  else
+    puts "Skipping the OpenTelemetry transaction backend: " \
+      "the opentelemetry-sdk gem is not installed"
+  end
+end
@@ -0,0 +1,58 @@
+# frozen_string_literal: true
+
+# Measures the memory unique to every forked worker process, the private
+# pages in `/proc/<pid>/smaps_rollup`, and prints the median as JSON. Run by
+# the `benchmark:prefork` task, which runs it with and without
+# `Appsignal.prefork` in the parent process. Linux only.
+#
+# Every worker runs transactions with events, errors and queries, so
+# AppSignal builds its state in the worker when the parent didn't.
+
+require "json"
+require "appsignal"
+require_relative "runner"
+require_relative "cases"
+
+WORKERS = (ENV["PREFORK_WORKERS"] || 4).to_i
+TRANSACTIONS = (ENV["PREFORK_TRANSACTIONS"] || 1_000).to_i
+
+def private_memory_kb
+  File.foreach("/proc/self/smaps_rollup").sum do |line|
+    line.start_with?("Private_") ? line.split[1].to_i : 0
+  end
+end
+
+Appsignal.configure(:production) do |config|
+  config.active = true
+  config.push_api_key = "benchmark"
+  config.endpoint = "http://localhost:8080"
+end
+Appsignal.start
+Appsignal.prefork if ENV["PREFORK"] == "true"
+GC.start
+
+readers = Array.new(WORKERS) do
+  reader, writer = IO.pipe
+  fork do
+    reader.close
+    Appsignal.forked
+    TRANSACTIONS.times do |i|
+      AppsignalBenchmark.monitor_transaction
+      Appsignal.report_error(AppsignalBenchmark.error) if (i % 100).zero?
+      Appsignal::Utils::QueryParamsSanitizer.sanitize("filter" => { "id" => i })
+    end
+    writer.puts(private_memory_kb)
+    writer.close
+    exit!(0)
+  end
+  writer.close
+  reader
+end
+Process.waitall
+private_kb = readers.map { |reader| reader.read.to_i }.sort
+
+puts JSON.generate(
+  "workers" => WORKERS,
+  "private_kb_median" => private_kb[WORKERS / 2],
+  "private_kb" => private_kb
+)
@@ -0,0 +1,209 @@
+# frozen_string_literal: true
+
+require "json"
+require "fileutils"
+require "time"
+
+module AppsignalBenchmark
+  # Runs the benchmark cases registered with {AppsignalBenchmark.bench}, and
+  # writes the results as JSON.
+  #
+  # Per case it measures, on one thread:
+  #
+  # - the time per operation, in nanoseconds;
+  # - the Ruby objects allocated per operation;
+  # - the growth of the process RSS per operation, in bytes.
+  #
+  # It then runs the same number of operations spread over every thread count
+  # in `THREADS`, and reports the operations per second for each, to show how
+  # the case scales when threads contend for the GVL and for locks.
+  #
+  # Configure a run with environment variables:
+  #
+  # - `ITERATIONS`: operations per measurement, default 10_000.
+  # - `THREADS`: comma separated thread counts, default "1,2,4,8".
+  # - `FILTER`: only run cases whose name includes this string.
+  # - `RESULTS`: path of the results JSON file.
+  class Runner
+    RESULTS_PATH = File.expand_path("../tmp/results.json", __dir__)
+    BASELINE_PATH = File.expand_path("../tmp/baseline.json", __dir__)
+
+    def initialize(
+      iterations: (ENV["ITERATIONS"] || 10_000).to_i,
+      threads: (ENV["THREADS"] || "1,2,4,8").split(",").map(&:to_i),
+      filter: ENV.fetch("FILTER", nil)
+    )
+      @iterations = iterations
+      @threads = threads
+      @filter = filter
+    end
+
+    def run
+      results = {}
+      AppsignalBenchmark.cases.each do |name, block|
+        next if @filter && !name.include?(@filter)
+
+        results[name] = measure(block)
+        print_result(name, results[name])
+      end
+
+      {
+        "meta" => meta,
+        "results" => results
+      }
+    end
+
+    def self.write(report, path = ENV["RESULTS"] || RESULTS_PATH)
+      FileUtils.mkdir_p(File.dirname(path))
+      File.write(path, JSON.pretty_generate(report))
+      puts "Results written to #{path}"
+    end
+
+    private
+
+    def measure(block)
+      # Warm up any caches and lazily defined methods first
+      [@iterations / 10, 1].max.times { |i| block.call(i) }
+      GC.start
+
+      rss_before = process_rss
+      allocations_before = GC.stat(:total_allocated_objects)
+      started_at = clock
+      @iterations.times { |i| block.call(i) }
+      duration = clock - started_at
+      allocations = GC.stat(:total_allocated_objects) - allocations_before
+      rss = process_rss - rss_before
+
+      {
+        "ns_per_op" => (duration.to_f / @iterations).round(1),
+        "allocations_per_op" => (allocations.to_f / @iterations).round(2),
+        "rss_bytes_per_op" => ((rss * 1024.0) / @iterations).round(2),
+        "ops_per_second_by_threads" => scaling(block)
+      }
+    end
+
+    def scaling(block)
+      @threads.to_h do |count|
+        per_thread = [@iterations / count, 1].max
+        started_at = clock
+        Array.new(count) do
+          Thread.new do
+            Thread.current.abort_on_exception = true
+            per_thread.times { |i| block.call(i) }
+          end
+        end.each(&:join)
+        duration = clock - started_at
+
+        [count.to_s, (per_thread * count * 1_000_000_000.0 / duration).round]
+      end
+    end
+
+    def print_result(name, result)
+      scaling = result["ops_per_second_by_threads"]
+        .map { |count, ops| "#{count}t=#{ops}" }
+        .join(" ")
+      puts format(
+        "%-48s %10.1f ns/op %8.2f allocs/op %10.2f B/op  %s",
+        name,
+        result["ns_per_op"],
+        result["allocations_per_op"],
+        result["rss_bytes_per_op"],
+        scaling
+      )
+    end
+
+    def meta
+      {
+        "ruby" => RUBY_DESCRIPTION,
+        "appsignal" => Appsignal::VERSION,
+        "stub_agent" => AppsignalBenchmark.stub_agent?,
+        "stub_agent_latency_ns" => ENV.fetch("APPSIGNAL_STUB_LATENCY_NS", "0").to_i,
+        "iterations" => @iterations,
+        "threads" => @threads,
+        "time" => Time.now.utc.iso8601
+      }
+    end
+
+    def clock
+      Process.clock_gettime(Process::CLOCK_MONOTONIC, :nanosecond)
+    end
+
+    def process_rss
+      `ps -o rss= -p #{Process.pid}`.to_i
+    end
+  end
+
+  # Compares a results JSON file against a baseline JSON file.
+  #
+  # Reports every case of which the time or allocations per operation
+  # increased by more than the threshold percentage, `THRESHOLD`, default 10.
+  class Comparison
+    METRICS = ["ns_per_op", "allocations_per_op"].freeze
+
+    def initialize(
+      results_path,
+      baseline_path,
+      threshold: (ENV["THRESHOLD"] || 10).to_f
+    )
+      @results = JSON.parse(File.read(results_path))["results"]
+      @baseline = JSON.parse(File.read(baseline_path))["results"]
+      @threshold = threshold
+    end
+
+    # Prints the comparison and returns the regressed cases.
+    def run
+      regressions = []
+      @results.each do |name, result|
+        baseline = @baseline[name]
+        unless baseline
+          puts "#{name}: new case, no baseline"
+          next
+        end
+
+        METRICS.each do |metric|
+          change = change_percentage(baseline[metric], result[metric])
+          next unless change
+
+          regressed = change > @threshold
+          regressions << "#{name} #{metric}" if regressed
+          puts format(
+            "%-48s %-20s %12.2f -> %12.2f %+8.1f%%%s",
+            name,
+            metric,
+            baseline[metric],
+            result[metric],
+            change,
+            regressed ? "  REGRESSION" : ""
+          )
+        end
+      end
+      regressions
+    end
+
+    private
+
+    def change_percentage(before, after)
+      return unless before && after
+      return 0.0 if before.zero? && after.zero?
+      return Float::INFINITY if before.zero?
+
+      (after - before) * 100.0 / before
+    end
+  end
+
+  class << self
+    def cases
+      @cases ||= {}
+    end
+
+    # Registers a benchmark case. The block is called once per operation with
+    # the iteration number.
+    def bench(name, &block)
+      cases[name] = block
+    end
+
+    def stub_agent?
+      !ENV["APPSIGNAL_STUB_AGENT"].nil?
+    end
+  end
+end
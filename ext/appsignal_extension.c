@@ -1,3 +1,4 @@
+#include <time.h>
 #include "ruby/ruby.h"
 #include "ruby/encoding.h"
 #include "appsignal.h"
@@ -45,6 +46,61 @@ VALUE Transaction;
 VALUE Data;
 VALUE Span;
 
+// Overhead accounting: the calls to and nanoseconds spent in the agent per
+// extension entry point, when enabled with
+// Appsignal::Extension.overhead_accounting=. Counted per thread, so a
+// transaction can diff two snapshots of the thread it runs on, like the
+// allocation count below, and per process for a summary. The process counters
+// are only updated while holding the GVL, so they don't need to be atomic.
+//
+// The thread counters are `__thread` variables, so they combine the counts of
+// all fibers that run on the same thread. A transaction's snapshots include
+// the agent calls of any fiber that ran on its thread in between.
+enum {
+  OVERHEAD_FINISH_EVENT,
+  OVERHEAD_SET_SAMPLE_DATA,
+  OVERHEAD_COMPLETE,
+  OVERHEAD_LOG,
+  OVERHEAD_METRICS,
+  OVERHEAD_ENTRY_POINTS
+};
+static const char* overhead_entry_point_names[OVERHEAD_ENTRY_POINTS] = {
+  "finish_event",
+  "set_sample_data",
+  "complete",
+  "log",
+  "metrics"
+};
+static VALUE overhead_entry_point_keys[OVERHEAD_ENTRY_POINTS];
+static int appsignal_overhead_accounting = 0;
+static __thread unsigned long long appsignal_thread_overhead[OVERHEAD_ENTRY_POINTS][2];
+static unsigned long long appsignal_process_overhead[OVERHEAD_ENTRY_POINTS][2];
+
+// Returns 0 when overhead accounting is disabled, so the clock is only read
+// when it's enabled.
+static inline unsigned long long overhead_clock(void) {
+  struct timespec now;
+
+  if (!appsignal_overhead_accounting) {
+    return 0;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long) now.tv_sec * 1000000000ULL + (unsigned long long) now.tv_nsec;
+}
+
+static inline void track_overhead(int entry_point, unsigned long long started_at) {
+  unsigned long long duration;
+
+  if (started_at == 0 || !appsignal_overhead_accounting) {
+    return;
+  }
+  duration = overhead_clock() - started_at;
+  appsignal_thread_overhead[entry_point][0]++;
+  appsignal_thread_overhead[entry_point][1] += duration;
+  appsignal_process_overhead[entry_point][0]++;
+  appsignal_process_overhead[entry_point][1] += duration;
+}
+
 static VALUE start(VALUE self) {
   appsignal_start();
 
@@ -110,6 +166,7 @@ static VALUE finish_event(VALUE self, VALUE name, VALUE title, VALUE body, VALUE
   appsignal_transaction_t* transaction;
   appsignal_data_t* body_data;
   int body_type;
+  unsigned long long overhead_started_at;
 
   Check_Type(name, T_STRING);
   Check_Type(title, T_STRING);
@@ -117,6 +174,7 @@ static VALUE finish_event(VALUE self, VALUE name, VALUE title, VALUE body, VALUE
 
   TypedData_Get_Struct(self, appsignal_transaction_t, &transaction_data_type, transaction);
 
+  overhead_started_at = overhead_clock();
   body_type = TYPE(body);
   if (body_type == T_STRING) {
     appsignal_finish_event(
@@ -140,6 +198,7 @@ static VALUE finish_event(VALUE self, VALUE name, VALUE title, VALUE body, VALUE
   } else {
       rb_raise(rb_eTypeError, "body should be a String or Appsignal::Extension::Data");
   }
+  track_overhead(OVERHEAD_FINISH_EVENT, overhead_started_at);
 
   return Qnil;
 }
@@ -148,6 +207,7 @@ static VALUE record_event(VALUE self, VALUE name, VALUE title, VALUE body, VALUE
   appsignal_transaction_t* transaction;
   appsignal_data_t* body_data;
   int body_type;
+  unsigned long long overhead_started_at;
   int duration_type;
 
   Check_Type(name, T_STRING);
@@ -160,6 +220,7 @@ static VALUE record_event(VALUE self, VALUE name, VALUE title, VALUE body, VALUE
 
   TypedData_Get_Struct(self, appsignal_transaction_t, &transaction_data_type, transaction);
 
+  overhead_started_at = overhead_clock();
   body_type = TYPE(body);
   if (body_type == T_STRING) {
     appsignal_record_event(
@@ -185,6 +246,7 @@ static VALUE record_event(VALUE self, VALUE name, VALUE title, VALUE body, VALUE
   } else {
       rb_raise(rb_eTypeError, "body should be a String or Appsignal::Extension::Data");
   }
+  track_overhead(OVERHEAD_FINISH_EVENT, overhead_started_at);
 
   return Qnil;
 }
@@ -209,9 +271,38 @@ static VALUE set_transaction_error(VALUE self, VALUE name, VALUE message, VALUE
   return Qnil;
 }
 
+// Only available when the agent library can hold more than one error per
+// transaction. Without it the Ruby side reports the additional errors as
+// duplicate transactions instead.
+#ifdef HAVE_APPSIGNAL_ADD_TRANSACTION_ERROR
+static VALUE add_transaction_error(VALUE self, VALUE name, VALUE message, VALUE backtrace, VALUE causes) {
+  appsignal_transaction_t* transaction;
+  appsignal_data_t* backtrace_data;
+  appsignal_data_t* causes_data;
+
+  Check_Type(name, T_STRING);
+  Check_Type(message, T_STRING);
+
+  backtrace_data = rb_check_typeddata(backtrace, &data_data_type);
+  causes_data = rb_check_typeddata(causes, &data_data_type);
+
+  TypedData_Get_Struct(self, appsignal_transaction_t, &transaction_data_type, transaction);
+
+  appsignal_add_transaction_error(
+      transaction,
+      make_appsignal_string(name),
+      make_appsignal_string(message),
+      backtrace_data,
+      causes_data
+  );
+  return Qnil;
+}
+#endif
+
 static VALUE set_transaction_sample_data(VALUE self, VALUE key, VALUE payload) {
   appsignal_transaction_t* transaction;
   appsignal_data_t* payload_data;
+  unsigned long long overhead_started_at;
 
   Check_Type(key, T_STRING);
 
@@ -219,11 +310,13 @@ static VALUE set_transaction_sample_data(VALUE self, VALUE key, VALUE payload) {
 
   TypedData_Get_Struct(self, appsignal_transaction_t, &transaction_data_type, transaction);
 
+  overhead_started_at = overhead_clock();
   appsignal_set_transaction_sample_data(
       transaction,
       make_appsignal_string(key),
       payload_data
   );
+  track_overhead(OVERHEAD_SET_SAMPLE_DATA, overhead_started_at);
   return Qnil;
 }
 
@@ -289,11 +382,14 @@ static VALUE set_transaction_metadata(VALUE self, VALUE key, VALUE value) {
 static VALUE finish_transaction(VALUE self, VALUE gc_duration_ms) {
   appsignal_transaction_t* transaction;
   int sample;
+  unsigned long long overhead_started_at;
 
   Check_Type(gc_duration_ms, T_FIXNUM);
   TypedData_Get_Struct(self, appsignal_transaction_t, &transaction_data_type, transaction);
 
+  overhead_started_at = overhead_clock();
   sample = appsignal_finish_transaction(transaction, NUM2LONG(gc_duration_ms));
+  track_overhead(OVERHEAD_COMPLETE, overhead_started_at);
   return sample == 1 ? Qtrue : Qfalse;
 }
 
@@ -322,10 +418,13 @@ static VALUE duplicate_transaction(VALUE self, VALUE new_transaction_id) {
 
 static VALUE complete_transaction(VALUE self) {
   appsignal_transaction_t* transaction;
+  unsigned long long overhead_started_at;
 
   TypedData_Get_Struct(self, appsignal_transaction_t, &transaction_data_type, transaction);
 
+  overhead_started_at = overhead_clock();
   appsignal_complete_transaction(transaction);
+  track_overhead(OVERHEAD_COMPLETE, overhead_started_at);
   return Qnil;
 }
 
@@ -740,6 +839,93 @@ static VALUE set_span_attribute_double(VALUE self, VALUE key, VALUE value) {
   return Qnil;
 }
 
+static int set_span_attributes_i(VALUE key, VALUE value, VALUE arg) {
+  appsignal_span_t* span = (appsignal_span_t*) arg;
+  appsignal_string_t key_string;
+  int64_t int_value;
+  int pack_result;
+  VALUE bigint_string;
+
+  if (TYPE(key) == T_SYMBOL) {
+    key = rb_sym2str(key);
+  } else if (TYPE(key) != T_STRING) {
+    key = rb_obj_as_string(key);
+  }
+  key_string = make_appsignal_string(key);
+
+  switch (TYPE(value)) {
+    case T_STRING:
+      appsignal_set_span_attribute_string(span, key_string, make_appsignal_string(value));
+      break;
+    case T_FIXNUM:
+      appsignal_set_span_attribute_int(span, key_string, NUM2LL(value));
+      break;
+    case T_BIGNUM:
+      // Integers that don't fit in 64 bits are set as a string, like
+      // `Appsignal::Span#[]=` does. Packing 2**63 doesn't report an overflow,
+      // but flips the sign.
+      pack_result = rb_integer_pack(value, &int_value, 1, sizeof(int64_t), 0, INTEGER_PACK_LSWORD_FIRST | INTEGER_PACK_NATIVE_BYTE_ORDER | INTEGER_PACK_2COMP);
+      if (pack_result == 2 || pack_result == -2 || (pack_result < 0) != (int_value < 0)) {
+        bigint_string = rb_str_concat(rb_str_new_cstr("bigint:"), rb_big2str(value, 10));
+        appsignal_set_span_attribute_string(span, key_string, make_appsignal_string(bigint_string));
+        RB_GC_GUARD(bigint_string);
+      } else {
+        appsignal_set_span_attribute_int(span, key_string, int_value);
+      }
+      break;
+    case T_TRUE:
+      appsignal_set_span_attribute_bool(span, key_string, 1);
+      break;
+    case T_FALSE:
+      appsignal_set_span_attribute_bool(span, key_string, 0);
+      break;
+    case T_FLOAT:
+      appsignal_set_span_attribute_double(span, key_string, RFLOAT_VALUE(value));
+      break;
+    default:
+      rb_raise(rb_eTypeError, "value needs to be a string, int, bool or float");
+  }
+
+  RB_GC_GUARD(key);
+  return ST_CONTINUE;
+}
+
+static VALUE set_span_attributes(VALUE self, VALUE attributes) {
+  appsignal_span_t* span;
+
+  Check_Type(attributes, T_HASH);
+
+  TypedData_Get_Struct(self, appsignal_span_t, &span_data_type, span);
+
+  rb_hash_foreach(attributes, set_span_attributes_i, (VALUE) span);
+
+  return Qnil;
+}
+
+static VALUE child_span_with(VALUE self, VALUE name, VALUE attributes) {
+  appsignal_span_t* parent;
+  appsignal_span_t* span;
+  VALUE child;
+
+  Check_Type(name, T_STRING);
+  Check_Type(attributes, T_HASH);
+
+  TypedData_Get_Struct(self, appsignal_span_t, &span_data_type, parent);
+
+  span = appsignal_create_child_span(parent);
+
+  if (!span) {
+    return Qnil;
+  }
+
+  // Wrap the span first, so it's freed if setting an attribute raises an error
+  child = TypedData_Wrap_Struct(Span, &span_data_type, span);
+  appsignal_set_span_name(span, make_appsignal_string(name));
+  rb_hash_foreach(attributes, set_span_attributes_i, (VALUE) span);
+
+  return child;
+}
+
 static VALUE span_to_json(VALUE self) {
   appsignal_span_t* span;
   appsignal_string_t json;
@@ -767,6 +953,7 @@ static VALUE close_span(VALUE self) {
 
 static VALUE a_log(VALUE self, VALUE group, VALUE severity, VALUE format, VALUE message, VALUE attributes) {
   appsignal_data_t* attributes_data;
+  unsigned long long overhead_started_at;
 
   Check_Type(group, T_STRING);
   Check_Type(severity, T_FIXNUM);
@@ -775,6 +962,7 @@ static VALUE a_log(VALUE self, VALUE group, VALUE severity, VALUE format, VALUE
 
   attributes_data = rb_check_typeddata(attributes, &data_data_type);
 
+  overhead_started_at = overhead_clock();
   appsignal_log(
       make_appsignal_string(group),
       FIX2INT(severity),
@@ -782,55 +970,65 @@ static VALUE a_log(VALUE self, VALUE group, VALUE severity, VALUE format, VALUE
       make_appsignal_string(message),
       attributes_data
    );
+  track_overhead(OVERHEAD_LOG, overhead_started_at);
 
   return Qnil;
 }
 
 static VALUE set_gauge(VALUE self, VALUE key, VALUE value, VALUE tags) {
   appsignal_data_t* tags_data;
+  unsigned long long overhead_started_at;
 
   Check_Type(key, T_STRING);
   Check_Type(value, T_FLOAT);
 
   tags_data = rb_check_typeddata(tags, &data_data_type);
 
+  overhead_started_at = overhead_clock();
   appsignal_set_gauge(
       make_appsignal_string(key),
       NUM2DBL(value),
       tags_data
   );
+  track_overhead(OVERHEAD_METRICS, overhead_started_at);
   return Qnil;
 }
 
 static VALUE increment_counter(VALUE self, VALUE key, VALUE count, VALUE tags) {
   appsignal_data_t* tags_data;
+  unsigned long long overhead_started_at;
 
   Check_Type(key, T_STRING);
   Check_Type(count, T_FLOAT);
 
   tags_data = rb_check_typeddata(tags, &data_data_type);
 
+  overhead_started_at = overhead_clock();
   appsignal_increment_counter(
       make_appsignal_string(key),
       NUM2DBL(count),
       tags_data
   );
+  track_overhead(OVERHEAD_METRICS, overhead_started_at);
   return Qnil;
 }
 
 static VALUE add_distribution_value(VALUE self, VALUE key, VALUE value, VALUE tags) {
   appsignal_data_t* tags_data;
+  unsigned long long overhead_started_at;
 
   Check_Type(key, T_STRING);
   Check_Type(value, T_FLOAT);
 
   tags_data = rb_check_typeddata(tags, &data_data_type);
 
+  overhead_started_at = overhead_clock();
   appsignal_add_distribution_value(
       make_appsignal_string(key),
       NUM2DBL(value),
       tags_data
   );
+  track_overhead(OVERHEAD_METRICS, overhead_started_at);
   return Qnil;
 }
 
@@ -864,6 +1062,463 @@ static VALUE install_allocation_event_hook(VALUE self) {
   return Qnil;
 }
 
+static VALUE set_overhead_accounting(VALUE self, VALUE enabled) {
+  appsignal_overhead_accounting = RTEST(enabled);
+  return enabled;
+}
+
+static VALUE overhead_counters(unsigned long long counters[OVERHEAD_ENTRY_POINTS][2]) {
+  VALUE hash = rb_hash_new();
+  int entry_point;
+
+  for (entry_point = 0; entry_point < OVERHEAD_ENTRY_POINTS; entry_point++) {
+    rb_hash_aset(
+        hash,
+        overhead_entry_point_keys[entry_point],
+        rb_assoc_new(ULL2NUM(counters[entry_point][0]), ULL2NUM(counters[entry_point][1]))
+    );
+  }
+  return hash;
+}
+
+// The running totals of the current thread. Diff two snapshots to get the
+// overhead of the work in between.
+static VALUE thread_overhead(VALUE self) {
+  return overhead_counters(appsignal_thread_overhead);
+}
+
+static VALUE overhead_summary(VALUE self) {
+  return overhead_counters(appsignal_process_overhead);
+}
+
+// Query params shapes: the structure of a query, as sanitized by
+// Appsignal::Utils::QueryParamsSanitizer, written to a String. Queries with
+// the same keys, the same nesting of Hashes and Arrays and any other values in
+// the same places have the same shape, and so the same sanitized result,
+// which the sanitizer caches by shape. The shape is written out in full
+// rather than hashed, so queries with different shapes never share a result.
+#define QUERY_SHAPE_MAX_DEPTH 32
+#define QUERY_SHAPE_MAX_DISTINCT 32
+#define QUERY_SHAPE_MAX_BYTES 4096
+
+// The shape is written to a buffer on the stack, and only copied to a String
+// when it's complete.
+typedef struct {
+  char bytes[QUERY_SHAPE_MAX_BYTES];
+  long len;
+  int only_top_level;
+  int depth;
+  int cacheable;
+} query_shape_t;
+
+static void write_query_shape(VALUE value, query_shape_t* shape);
+
+static void write_query_shape_bytes(query_shape_t* shape, const char* bytes, long len) {
+  if (shape->len + len > QUERY_SHAPE_MAX_BYTES) {
+    shape->cacheable = 0;
+    return;
+  }
+  memcpy(shape->bytes + shape->len, bytes, len);
+  shape->len += len;
+}
+
+static void write_query_shape_mark(query_shape_t* shape, char mark) {
+  if (shape->len == QUERY_SHAPE_MAX_BYTES) {
+    shape->cacheable = 0;
+    return;
+  }
+  shape->bytes[shape->len++] = mark;
+}
+
+static int write_query_shape_key(VALUE key, query_shape_t* shape) {
+  long len;
+
+  switch (TYPE(key)) {
+    case T_STRING:
+      write_query_shape_mark(shape, 's');
+      break;
+    case T_SYMBOL:
+      write_query_shape_mark(shape, 'y');
+      key = rb_sym2str(key);
+      break;
+    default:
+      // The sanitized key is the key itself, or the key as a String for
+      // MongoDB, which only Strings and Symbols can be cached by content.
+      return 0;
+  }
+  // The length goes first, so a key can't run into what follows it
+  len = RSTRING_LEN(key);
+  write_query_shape_bytes(shape, (const char*) &len, sizeof(len));
+  write_query_shape_bytes(shape, RSTRING_PTR(key), len);
+  return 1;
+}
+
+static int write_query_shape_pair(VALUE key, VALUE value, VALUE arg) {
+  query_shape_t* shape = (query_shape_t*) arg;
+
+  if (!write_query_shape_key(key, shape)) {
+    shape->cacheable = 0;
+    return ST_STOP;
+  }
+  if (shape->only_top_level) {
+    write_query_shape_mark(shape, 'v');
+  } else {
+    write_query_shape(value, shape);
+  }
+  return shape->cacheable ? ST_CONTINUE : ST_STOP;
+}
+
+// The sanitized Array only contains the distinct sanitized values, so only
+// write the distinct shapes of the values in order, like `Array#uniq`. Every
+// value's shape ends where it started nesting, so a shape that was written
+// before is found by comparing the bytes.
+static void write_query_shape_array(VALUE array, query_shape_t* shape) {
+  long distinct_start[QUERY_SHAPE_MAX_DISTINCT];
+  long distinct_len[QUERY_SHAPE_MAX_DISTINCT];
+  long distinct_count = 0;
+  long start;
+  long len;
+  long i;
+  long j;
+
+  for (i = 0; i < RARRAY_LEN(array); i++) {
+    start = shape->len;
+    write_query_shape(RARRAY_AREF(array, i), shape);
+    if (!shape->cacheable) {
+      return;
+    }
+    len = shape->len - start;
+
+    for (j = 0; j < distinct_count; j++) {
+      if (distinct_len[j] == len &&
+          memcmp(shape->bytes + distinct_start[j], shape->bytes + start, len) == 0) {
+        break;
+      }
+    }
+    if (j < distinct_count) {
+      // Already seen, like `Array#uniq`
+      shape->len = start;
+      continue;
+    }
+    if (distinct_count == QUERY_SHAPE_MAX_DISTINCT) {
+      shape->cacheable = 0;
+      return;
+    }
+    distinct_start[distinct_count] = start;
+    distinct_len[distinct_count] = len;
+    distinct_count++;
+  }
+}
+
+static void write_query_shape(VALUE value, query_shape_t* shape) {
+
+  if (shape->depth >= QUERY_SHAPE_MAX_DEPTH) {
+    shape->cacheable = 0;
+    return;
+  }
+
+  switch (TYPE(value)) {
+    case T_HASH:
+      write_query_shape_mark(shape, 'h');
+      shape->depth++;
+      rb_hash_foreach(value, write_query_shape_pair, (VALUE) shape);
+      shape->depth--;
+      write_query_shape_mark(shape, 'H');
+      break;
+    case T_ARRAY:
+      write_query_shape_mark(shape, 'a');
+      shape->depth++;
+      if (shape->only_top_level) {
+        // Only the first value of an Array is sanitized
+        write_query_shape(rb_ary_entry(value, 0), shape);
+      } else {
+        write_query_shape_array(value, shape);
+      }
+      shape->depth--;
+      write_query_shape_mark(shape, 'A');
+      break;
+    default:
+      // Every other value is replaced with a question mark
+      write_query_shape_mark(shape, 'v');
+  }
+}
+
+// Returns the shape of the params as a frozen binary String, or nil if the
+// params can't be cached by shape: when they're nested too deep, have too
+// many distinct values in an Array, have a shape that's too long, or have
+// keys other than Strings and Symbols.
+static VALUE query_params_shape(VALUE self, VALUE params, VALUE only_top_level, VALUE mongodb) {
+  query_shape_t shape;
+
+  shape.len = 0;
+  shape.only_top_level = RTEST(only_top_level);
+  shape.depth = 0;
+  shape.cacheable = 1;
+
+  // The options change the sanitized result, so they're part of the shape
+  write_query_shape_mark(&shape, (char) ('0' + ((shape.only_top_level << 1) | RTEST(mongodb))));
+  write_query_shape(params, &shape);
+
+  if (!shape.cacheable) {
+    return Qnil;
+  }
+  return rb_obj_freeze(rb_str_new(shape.bytes, shape.len));
+}
+
+// Action histograms: the durations of the transactions per namespace and
+// action, per minute, when enabled with the enable_action_histograms config
+// option. Every histogram has a fixed number of log-linear buckets, 16 per
+// power of two, so a duration is counted within about 3% of its value, from
+// one microsecond to 2^40 microseconds. The number of actions per minute is
+// limited too, so the memory used doesn't depend on the number of requests.
+//
+// The durations are counted in the table of the current minute. When the
+// minute has passed, the table becomes the completed table, of which
+// Appsignal::Extension.action_histograms returns the percentiles. Like the
+// process overhead counters, the tables are only used while holding the GVL.
+#define ACTION_HISTOGRAM_SUB_BUCKET_BITS 4
+#define ACTION_HISTOGRAM_SUB_BUCKETS (1 << ACTION_HISTOGRAM_SUB_BUCKET_BITS)
+#define ACTION_HISTOGRAM_MAX_EXPONENT 40
+#define ACTION_HISTOGRAM_BUCKETS \
+  ((ACTION_HISTOGRAM_MAX_EXPONENT - ACTION_HISTOGRAM_SUB_BUCKET_BITS + 2) * ACTION_HISTOGRAM_SUB_BUCKETS)
+#define ACTION_HISTOGRAM_SLOTS 256
+#define ACTION_HISTOGRAM_MAX_ACTIONS 192
+
+typedef struct {
+  // NULL when the slot is not used this minute
+  char* namespace;
+  long namespace_len;
+  char* action;
+  long action_len;
+  st_index_t hash;
+  unsigned long long count;
+  unsigned long long max;
+  // Allocated when the slot is first used, and kept for the next minutes
+  unsigned int* buckets;
+} action_histogram_t;
+
+typedef struct {
+  long minute;
+  int actions;
+  action_histogram_t slots[ACTION_HISTOGRAM_SLOTS];
+} action_histogram_table_t;
+
+static action_histogram_table_t action_histogram_tables[2];
+static action_histogram_table_t* action_histogram_current = &action_histogram_tables[0];
+static action_histogram_table_t* action_histogram_completed = &action_histogram_tables[1];
+static const double action_histogram_percentiles[] = { 0.5, 0.95, 0.99 };
+
+static inline int action_histogram_bucket(unsigned long long value) {
+  int exponent;
+
+  if (value < ACTION_HISTOGRAM_SUB_BUCKETS) {
+    return (int) value;
+  }
+  exponent = 63 - __builtin_clzll(value);
+  if (exponent > ACTION_HISTOGRAM_MAX_EXPONENT) {
+    return ACTION_HISTOGRAM_BUCKETS - 1;
+  }
+  return (exponent - ACTION_HISTOGRAM_SUB_BUCKET_BITS + 1) * ACTION_HISTOGRAM_SUB_BUCKETS +
+    (int) ((value >> (exponent - ACTION_HISTOGRAM_SUB_BUCKET_BITS)) - ACTION_HISTOGRAM_SUB_BUCKETS);
+}
+
+// The middle of the range of values counted in the bucket
+static inline unsigned long long action_histogram_bucket_value(int bucket) {
+  int shift;
+  unsigned long long lowest;
+
+  if (bucket < ACTION_HISTOGRAM_SUB_BUCKETS) {
+    return bucket;
+  }
+  shift = bucket / ACTION_HISTOGRAM_SUB_BUCKETS - 1;
+  lowest = (unsigned long long) (ACTION_HISTOGRAM_SUB_BUCKETS + bucket % ACTION_HISTOGRAM_SUB_BUCKETS) << shift;
+  return lowest + ((1ULL << shift) >> 1);
+}
+
+static void clear_action_histograms(action_histogram_table_t* table) {
+  int slot;
+  action_histogram_t* histogram;
+
+  for (slot = 0; slot < ACTION_HISTOGRAM_SLOTS; slot++) {
+    histogram = &table->slots[slot];
+    if (histogram->namespace == NULL) {
+      continue;
+    }
+    xfree(histogram->namespace);
+    xfree(histogram->action);
+    histogram->namespace = NULL;
+    histogram->action = NULL;
+    histogram->count = 0;
+    histogram->max = 0;
+    memset(histogram->buckets, 0, sizeof(unsigned int) * ACTION_HISTOGRAM_BUCKETS);
+  }
+  table->actions = 0;
+}
+
+// Make the current table the completed table once its minute has passed, or
+// when forced. Returns 1 if the completed table has durations to report.
+static int rotate_action_histograms(long minute, int force) {
+  action_histogram_table_t* completed;
+
+  if (action_histogram_current->minute == minute && !force) {
+    return 0;
+  }
+  // The durations of a minute that were never reported are dropped
+  clear_action_histograms(action_histogram_completed);
+  completed = action_histogram_current;
+  action_histogram_current = action_histogram_completed;
+  action_histogram_completed = completed;
+  action_histogram_current->minute = minute;
+  return action_histogram_completed->actions > 0;
+}
+
+static action_histogram_t* find_action_histogram(VALUE namespace, VALUE action) {
+  st_index_t hash;
+  int slot;
+  int probe;
+  action_histogram_t* histogram;
+
+  hash = rb_memhash(RSTRING_PTR(namespace), RSTRING_LEN(namespace));
+  hash = rb_hash_uint(hash, rb_memhash(RSTRING_PTR(action), RSTRING_LEN(action)));
+
+  for (probe = 0; probe < ACTION_HISTOGRAM_SLOTS; probe++) {
+    slot = (int) ((hash + probe) & (ACTION_HISTOGRAM_SLOTS - 1));
+    histogram = &action_histogram_current->slots[slot];
+    if (histogram->namespace == NULL) {
+      if (action_histogram_current->actions >= ACTION_HISTOGRAM_MAX_ACTIONS) {
+        return NULL;
+      }
+      histogram->namespace_len = RSTRING_LEN(namespace);
+      histogram->namespace = xmalloc(histogram->namespace_len);
+      memcpy(histogram->namespace, RSTRING_PTR(namespace), histogram->namespace_len);
+      histogram->action_len = RSTRING_LEN(action);
+      histogram->action = xmalloc(histogram->action_len);
+      memcpy(histogram->action, RSTRING_PTR(action), histogram->action_len);
+      histogram->hash = hash;
+      if (histogram->buckets == NULL) {
+        histogram->buckets = ZALLOC_N(unsigned int, ACTION_HISTOGRAM_BUCKETS);
+      }
+      action_histogram_current->actions++;
+      return histogram;
+    }
+    if (histogram->hash == hash &&
+        histogram->namespace_len == RSTRING_LEN(namespace) &&
+        histogram->action_len == RSTRING_LEN(action) &&
+        memcmp(histogram->namespace, RSTRING_PTR(namespace), histogram->namespace_len) == 0 &&
+        memcmp(histogram->action, RSTRING_PTR(action), histogram->action_len) == 0) {
+      return histogram;
+    }
+  }
+  return NULL;
+}
+
+// Counts the duration, in nanoseconds, for the namespace and action. The first
+// duration of a new minute moves the previous minute to the completed table,
+// but doesn't report it: Appsignal::ActionHistograms reports it from its own
+// thread, so no transaction pays for reporting every action.
+static VALUE record_action_duration(VALUE self, VALUE namespace, VALUE action, VALUE duration_ns) {
+  long long duration_us;
+  action_histogram_t* histogram;
+
+  Check_Type(duration_ns, T_FIXNUM);
+  // Transactions are completed without a Ruby error, so these are skipped
+  if (TYPE(namespace) != T_STRING || TYPE(action) != T_STRING) {
+    return Qnil;
+  }
+
+  rotate_action_histograms((long) (time(NULL) / 60), 0);
+  histogram = find_action_histogram(namespace, action);
+  if (histogram != NULL) {
+    duration_us = FIX2LONG(duration_ns) / 1000;
+    if (duration_us < 0) {
+      duration_us = 0;
+    }
+    histogram->buckets[action_histogram_bucket((unsigned long long) duration_us)]++;
+    histogram->count++;
+    if ((unsigned long long) duration_us > histogram->max) {
+      histogram->max = (unsigned long long) duration_us;
+    }
+  }
+  return Qnil;
+}
+
+static VALUE action_histogram_summary(action_histogram_t* histogram) {
+  VALUE summary = rb_ary_new_capa(7);
+  unsigned long long seen = 0;
+  unsigned long long rank;
+  unsigned long long value;
+  int percentile = 0;
+  int percentiles = sizeof(action_histogram_percentiles) / sizeof(action_histogram_percentiles[0]);
+  int bucket;
+
+  rb_ary_push(summary, make_ruby_string((appsignal_string_t) {
+    .len = histogram->namespace_len,
+    .buf = histogram->namespace
+  }));
+  rb_ary_push(summary, make_ruby_string((appsignal_string_t) {
+    .len = histogram->action_len,
+    .buf = histogram->action
+  }));
+  rb_ary_push(summary, ULL2NUM(histogram->count));
+
+  for (bucket = 0; bucket < ACTION_HISTOGRAM_BUCKETS && percentile < percentiles; bucket++) {
+    seen += histogram->buckets[bucket];
+    while (percentile < percentiles) {
+      rank = (unsigned long long) (action_histogram_percentiles[percentile] * histogram->count + 0.5);
+      if (rank < 1) {
+        rank = 1;
+      }
+      if (seen < rank) {
+        break;
+      }
+      value = action_histogram_bucket_value(bucket);
+      if (value > histogram->max) {
+        value = histogram->max;
+      }
+      rb_ary_push(summary, DBL2NUM(value / 1000.0));
+      percentile++;
+    }
+  }
+  rb_ary_push(summary, DBL2NUM(histogram->max / 1000.0));
+  return summary;
+}
+
+static void push_completed_action_histograms(VALUE summaries) {
+  int slot;
+
+  for (slot = 0; slot < ACTION_HISTOGRAM_SLOTS; slot++) {
+    if (action_histogram_completed->slots[slot].namespace != NULL) {
+      rb_ary_push(summaries, action_histogram_summary(&action_histogram_completed->slots[slot]));
+    }
+  }
+  clear_action_histograms(action_histogram_completed);
+}
+
+// Returns the durations of the last completed minute, and clears them, as an
+// Array of `[namespace, action, count, p50, p95, p99, max]` per action, with
+// the durations in milliseconds. With `include_current` the durations of the
+// current minute are returned too, like when AppSignal stops.
+static VALUE action_histograms(VALUE self, VALUE include_current) {
+  VALUE summaries = rb_ary_new();
+  long minute = (long) (time(NULL) / 60);
+
+  rotate_action_histograms(minute, 0);
+  push_completed_action_histograms(summaries);
+  if (RTEST(include_current)) {
+    rotate_action_histograms(minute, 1);
+    push_completed_action_histograms(summaries);
+  }
+  return summaries;
+}
+
+// Drops the durations counted so far, like those counted by the parent
+// process before a fork.
+static VALUE reset_action_histograms(VALUE self) {
+  clear_action_histograms(action_histogram_current);
+  clear_action_histograms(action_histogram_completed);
+  return Qnil;
+}
+
 static VALUE running_in_container(VALUE self) {
   return appsignal_running_in_container() == 1 ? Qtrue : Qfalse;
 }
@@ -877,6 +1532,8 @@ static VALUE set_environment_metadata(VALUE self, VALUE key, VALUE value) {
 }
 
 void Init_appsignal_extension(void) {
+  int entry_point;
+
   Appsignal = rb_define_module("Appsignal");
   Extension = rb_define_class_under(Appsignal, "Extension", rb_cObject);
   rb_undef_alloc_func(Extension);
@@ -906,6 +1563,9 @@ void Init_appsignal_extension(void) {
   rb_define_method(Transaction, "finish_event",    finish_event,                5);
   rb_define_method(Transaction, "record_event",    record_event,                6);
   rb_define_method(Transaction, "set_error",       set_transaction_error,       3);
+#ifdef HAVE_APPSIGNAL_ADD_TRANSACTION_ERROR
+  rb_define_method(Transaction, "add_error",       add_transaction_error,       4);
+#endif
   rb_define_method(Transaction, "set_sample_data", set_transaction_sample_data, 2);
   rb_define_method(Transaction, "set_action",      set_transaction_action,      1);
   rb_define_method(Transaction, "set_namespace",   set_transaction_namespace,   1);
@@ -945,6 +1605,7 @@ void Init_appsignal_extension(void) {
   // Create a span
   rb_define_singleton_method(Span, "root", root_span_new, 1);
   rb_define_method(Span, "child", child_span_new, 0);
+  rb_define_method(Span, "child_with", child_span_with, 2);
 
   // Set span error
   rb_define_method(Span, "add_error", add_span_error, 3);
@@ -960,6 +1621,7 @@ void Init_appsignal_extension(void) {
   rb_define_method(Span, "set_attribute_int",    set_span_attribute_int,    2);
   rb_define_method(Span, "set_attribute_bool",   set_span_attribute_bool,   2);
   rb_define_method(Span, "set_attribute_double", set_span_attribute_double, 2);
+  rb_define_method(Span, "set_attributes",       set_span_attributes,       1);
 
   // Span to json
   rb_define_method(Span, "to_json", span_to_json, 0);
@@ -972,9 +1634,23 @@ void Init_appsignal_extension(void) {
   rb_define_singleton_method(Extension, "allocation_count", allocation_count, 0);
   rb_define_singleton_method(Extension, "running_in_container?", running_in_container, 0);
   rb_define_singleton_method(Extension, "set_environment_metadata", set_environment_metadata, 2);
+  rb_define_singleton_method(Extension, "query_params_shape", query_params_shape, 3);
 
   // Metrics
   rb_define_singleton_method(Extension, "set_gauge",              set_gauge,              3);
   rb_define_singleton_method(Extension, "increment_counter",      increment_counter,      3);
   rb_define_singleton_method(Extension, "add_distribution_value", add_distribution_value, 3);
+
+  // Overhead accounting
+  for (entry_point = 0; entry_point < OVERHEAD_ENTRY_POINTS; entry_point++) {
+    overhead_entry_point_keys[entry_point] = ID2SYM(rb_intern(overhead_entry_point_names[entry_point]));
+  }
+  rb_define_singleton_method(Extension, "overhead_accounting=", set_overhead_accounting, 1);
+  rb_define_singleton_method(Extension, "thread_overhead",      thread_overhead,         0);
+  rb_define_singleton_method(Extension, "overhead_summary",     overhead_summary,        0);
+
+  // Action histograms
+  rb_define_singleton_method(Extension, "record_action_duration",  record_action_duration,  3);
+  rb_define_singleton_method(Extension, "action_histograms",       action_histograms,       1);
+  rb_define_singleton_method(Extension, "reset_action_histograms", reset_action_histograms, 0);
 }
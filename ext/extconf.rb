@@ -48,6 +48,9 @@ def install
       $LDFLAGS += " -static-libgcc" # rubocop:disable Style/GlobalVars
       report["build"]["flags"]["LDFLAGS"] = $LDFLAGS # rubocop:disable Style/GlobalVars
     end
+    # Optional agent functions. The extension only wraps them when the agent
+    # library provides them.
+    have_func("appsignal_add_transaction_error", "appsignal.h")
     create_makefile "appsignal_extension"
     successful_installation
   end
@@ -142,6 +142,8 @@ module Appsignal
             "(#{$PROGRAM_NAME}, Ruby #{RUBY_VERSION}, #{RUBY_PLATFORM})"
           config.write_to_environment
           Appsignal::Extension.start
+          Appsignal::Overhead.start(config)
+          Appsignal::ActionHistograms.start(config)
           Appsignal::Hooks.load_hooks
           Appsignal::Loaders.start
 
@@ -255,6 +257,7 @@ module Appsignal
         else
           internal_logger.info("Stopping AppSignal")
         end
+        Appsignal::ActionHistograms.stop
         Appsignal::Extension.stop
         Appsignal::Probes.stop
         Appsignal::CheckIn.stop
@@ -371,13 +374,52 @@ module Appsignal
       nil
     end
 
+    # Prepare AppSignal for forking worker processes.
+    #
+    # Call this in the parent process of a preforking server, once the app
+    # is loaded and right before the workers are forked. For example, in the
+    # `before_fork` config of Puma or Unicorn.
+    #
+    # It builds the state that AppSignal otherwise builds on first use,
+    # separately in every worker process. The workers then share this state
+    # with the parent process as copy-on-write memory. Call {forked} in every
+    # worker process after the fork.
+    #
+    # @example Prepare AppSignal in a Puma config
+    #   before_fork do
+    #     Appsignal.prefork
+    #   end
+    #
+    # @return [void]
+    # @see forked
+    def prefork
+      return unless active?
+
+      internal_logger.debug("Preparing AppSignal to fork worker processes")
+      Appsignal::Hooks.prefork
+      Appsignal::EventFormatter.prefork
+      Appsignal::Utils::QueryParamsSanitizer.prefork
+      Appsignal::Transaction.prefork
+      Appsignal::Metrics::OpenTelemetryBackend.prefork if config.collector_mode_configured?
+      nil
+    end
+
+    # Restart AppSignal in a forked process.
+    #
+    # Only the state that belongs to a process is started again: the logger,
+    # the extension and the check-in scheduler thread. The state built in
+    # the parent process, see {prefork}, is used as is.
+    #
     # @return [void]
+    # @see prefork
     def forked
       return unless active?
 
       Appsignal._start_logger
       internal_logger.debug("Forked process, resubscribing and restarting extension")
       Appsignal::Extension.start
+      Appsignal::CheckIn.forked
+      Appsignal::ActionHistograms.forked
       nil
     end
 
@@ -671,6 +713,8 @@ require "appsignal/probes"
 require "appsignal/marker"
 require "appsignal/custom_marker"
 require "appsignal/garbage_collection"
+require "appsignal/overhead"
+require "appsignal/action_histograms"
 require "appsignal/rack"
 require "appsignal/rack/body_wrapper"
 require "appsignal/rack/abstract_middleware"
@@ -0,0 +1,132 @@
+# frozen_string_literal: true
+
+module Appsignal
+  # @!visibility private
+  #
+  # Reports the duration percentiles of the transactions per namespace and
+  # action, when the `enable_action_histograms` config option is enabled.
+  #
+  # The extension counts the duration of every completed transaction in a
+  # histogram per namespace and action, with a fixed number of buckets. Once
+  # per minute, the percentiles of the last minute are reported as the
+  # `transaction_duration_percentile` gauge in milliseconds, tagged with the
+  # namespace, action and percentile, and the number of transactions as the
+  # `transaction_duration_count` gauge. The gauges are tagged with the
+  # hostname too. The histograms are per process, and their percentiles can't
+  # be merged, so with more than one process per host the last process to
+  # report sets the gauges for that minute.
+  #
+  # Transactions only count their duration. Every process reports its
+  # durations from a reporter thread of its own, never on the request thread,
+  # and once more on stop. The reporter is started on start and again in a
+  # forked process, as threads don't survive a fork. It doesn't depend on the
+  # minutely probes, which don't run in forked processes.
+  module ActionHistograms
+    PERCENTILE_METRIC_NAME = "transaction_duration_percentile"
+    COUNT_METRIC_NAME = "transaction_duration_count"
+    # The order of the percentiles returned by the extension
+    PERCENTILES = ["p50", "p95", "p99", "max"].freeze
+
+    class << self
+      def start(config)
+        # Not supported by the JRuby extension
+        supported = Appsignal::Extension.respond_to?(:record_action_duration)
+        @enabled = supported && config[:enable_action_histograms] == true
+        stop_reporter
+        return unless @enabled
+
+        @hostname = config[:hostname] || Socket.gethostname
+        start_reporter
+      end
+
+      # Report the durations that weren't reported yet, and stop reporting.
+      def stop
+        return unless enabled?
+
+        stop_reporter
+        report(:include_current => true)
+        @enabled = false
+      end
+
+      def enabled?
+        @enabled == true
+      end
+
+      def clock
+        Process.clock_gettime(Process::CLOCK_MONOTONIC, :nanosecond)
+      end
+
+      # @param namespace [String]
+      # @param action [String]
+      # @param duration [Integer] the duration of the transaction in
+      #   nanoseconds.
+      def record(namespace, action, duration)
+        Appsignal::Extension.record_action_duration(namespace, action, duration)
+        nil
+      end
+
+      # Report the durations of the last completed minute. With
+      # `include_current`, report the durations of the current minute too.
+      def report(include_current: false)
+        return unless enabled?
+
+        histograms = Appsignal::Extension.action_histograms(include_current)
+        return if histograms.empty?
+
+        histograms.each do |namespace, action, count, *durations|
+          tags = { :namespace => namespace, :action => action, :hostname => @hostname }
+          Appsignal.set_gauge(COUNT_METRIC_NAME, count, tags)
+          PERCENTILES.zip(durations) do |percentile, duration|
+            Appsignal.set_gauge(
+              PERCENTILE_METRIC_NAME,
+              duration,
+              tags.merge(:percentile => percentile)
+            )
+          end
+        end
+      end
+
+      # Drop the durations counted by the parent process, and start a
+      # reporter for this process. The parent's reporter thread doesn't run
+      # in the forked process.
+      def forked
+        return unless enabled?
+
+        Appsignal::Extension.reset_action_histograms
+        start_reporter
+      end
+
+      # @!visibility private
+      def reporter
+        @reporter
+      end
+
+      private
+
+      # Report every minute, right after it has passed, so all durations of
+      # the minute are counted.
+      def start_reporter
+        stop_reporter
+        @reporter = Thread.new do
+          # Advise multi-threaded app servers to ignore this thread
+          # for the purposes of fork safety warnings
+          Thread.current.thread_variable_set(:fork_safe, true)
+
+          loop do
+            sleep(60 - Time.now.sec)
+            report
+          rescue => ex
+            Appsignal.internal_logger.error(
+              "Error while reporting action histograms: #{ex.class}: #{ex.message}"
+            )
+          end
+        end
+      end
+
+      def stop_reporter
+        @reporter&.kill
+        @reporter = nil
+      end
+    end
+  end
+end
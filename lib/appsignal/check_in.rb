@@ -102,6 +102,18 @@ module Appsignal
       def stop
         scheduler&.stop
       end
+
+      # The scheduler and heartbeat threads of the parent process don't run
+      # in a forked process. Start with a new scheduler, which starts its own
+      # threads when an event is scheduled.
+      #
+      # @!visibility private
+      def forked
+        NEW_SCHEDULER_MUTEX.synchronize do
+          @scheduler = nil
+        end
+        continuous_heartbeats.clear
+      end
     end
   end
 end
@@ -87,6 +87,28 @@ module Appsignal
       end
     end
 
+    # The config options read on every transaction, compiled into lookups
+    # that don't scan the configured Arrays. Created once per config, see
+    # {Config#snapshot}, and frozen, so it can be shared between threads.
+    #
+    # @!visibility private
+    class Snapshot
+      attr_reader :filter_metadata, :filter_parameters, :filter_session_data
+
+      def initialize(config_hash)
+        @filter_metadata = key_filter(config_hash[:filter_metadata])
+        @filter_parameters = key_filter(config_hash[:filter_parameters])
+        @filter_session_data = key_filter(config_hash[:filter_session_data])
+        freeze
+      end
+
+      private
+
+      def key_filter(keys)
+        Appsignal::Utils::KeyFilter.new(keys || [])
+      end
+    end
+
     # @!visibility private
     DEFAULT_CONFIG = {
       :activejob_report_errors => "all",
@@ -106,6 +128,10 @@ module Appsignal
       :enable_rails_error_reporter => true,
       :enable_active_support_event_log_reporter => false,
       :enable_rake_performance_instrumentation => false,
+      :enable_rack_streaming_instrumentation => false,
+      :enable_lazy_hooks => false,
+      :enable_overhead_accounting => false,
+      :enable_action_histograms => false,
       :endpoint => "https://push.appsignal.com",
       :files_world_accessible => true,
       :filter_attributes => [],
@@ -214,6 +240,11 @@ module Appsignal
         "APPSIGNAL_ENABLE_ACTIVE_SUPPORT_EVENT_LOG_REPORTER",
       :enable_rake_performance_instrumentation =>
         "APPSIGNAL_ENABLE_RAKE_PERFORMANCE_INSTRUMENTATION",
+      :enable_rack_streaming_instrumentation =>
+        "APPSIGNAL_ENABLE_RACK_STREAMING_INSTRUMENTATION",
+      :enable_lazy_hooks => "APPSIGNAL_ENABLE_LAZY_HOOKS",
+      :enable_overhead_accounting => "APPSIGNAL_ENABLE_OVERHEAD_ACCOUNTING",
+      :enable_action_histograms => "APPSIGNAL_ENABLE_ACTION_HISTOGRAMS",
       :files_world_accessible => "APPSIGNAL_FILES_WORLD_ACCESSIBLE",
       :instrument_active_job => "APPSIGNAL_INSTRUMENT_ACTIVE_JOB",
       :instrument_code_ownership => "APPSIGNAL_INSTRUMENT_CODE_OWNERSHIP",
@@ -443,6 +474,7 @@ module Appsignal
     # @return [void]
     # @!visibility private
     def []=(key, value)
+      @snapshot = nil
       config_hash[key] = value
     end
 
@@ -665,11 +697,27 @@ module Appsignal
     # @!visibility private
     # @since 4.0.0
     def freeze
+      @snapshot = Snapshot.new(config_hash)
       super
       config_hash.freeze
       config_hash.transform_values(&:freeze)
     end
 
+    # The options read on every transaction, compiled for fast lookups. See
+    # {Snapshot}.
+    #
+    # The snapshot is created on first use, and cleared when options are set
+    # with {#[]=}, {#merge_dsl_options} or {#apply_overrides}. A config that
+    # is never frozen does not compile the filters again on every call. The
+    # snapshot is created again when the config is frozen on start, in case
+    # an option's value was changed in place.
+    #
+    # @return [Snapshot]
+    # @!visibility private
+    def snapshot
+      @snapshot ||= Snapshot.new(config_hash)
+    end
+
     # @api private
     def yml_config_file?
       return false unless yml_config_file
@@ -858,6 +906,7 @@ module Appsignal
     end
 
     def merge(new_config)
+      @snapshot = nil
       new_config.each do |key, value|
         logger.debug("Config key '#{key}' is being overwritten") unless config_hash[key].nil?
         config_hash[key] = value
@@ -1004,6 +1053,15 @@ module Appsignal
       #   @return [Boolean] Configure whether ActiveSupport::EventReporter integration is enabled
       # @!attribute [rw] enable_rake_performance_instrumentation
       #   @return [Boolean] Configure whether Rake performance instrumentation is enabled
+      # @!attribute [rw] enable_rack_streaming_instrumentation
+      #   @return [Boolean] Configure whether streamed Rack response bodies are measured
+      # @!attribute [rw] enable_lazy_hooks
+      #   @return [Boolean] Configure whether integrations of libraries that aren't loaded on
+      #     start are installed once the library is required
+      # @!attribute [rw] enable_overhead_accounting
+      #   @return [Boolean] Configure whether the time AppSignal adds to transactions is reported
+      # @!attribute [rw] enable_action_histograms
+      #   @return [Boolean] Configure whether the duration percentiles per action are reported
       # @!attribute [rw] files_world_accessible
       #   @return [Boolean] Configure whether files created by AppSignal should be world accessible
       # @!attribute [rw] instrument_active_job
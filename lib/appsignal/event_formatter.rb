@@ -96,6 +96,16 @@ module Appsignal
         end
       end
 
+      # Build the state of the registered formatters before forking, see
+      # {Appsignal.prefork}.
+      #
+      # @!visibility private
+      def prefork
+        formatters.each_value do |formatter|
+          formatter.prefork if formatter.respond_to?(:prefork)
+        end
+      end
+
       # @!visibility private
       def format(name, payload)
         formatter = formatters[name]
@@ -158,8 +168,6 @@ module Appsignal
         formatter.record?
       end
 
-      private
-
       # The formatter registered for an event name.
       #
       # A formatter is registered under whatever key was given to `register`,
@@ -169,10 +177,14 @@ module Appsignal
       # `format` does not do this, on purpose. It has always looked a name up
       # exactly as given, so making it match a Symbol name would start giving a
       # title to events that have never had one.
+      #
+      # @!visibility private
       def formatter_for(name)
         formatters[name] || formatters[name.to_s]
       end
 
+      private
+
       def initialize_formatter(name, formatter)
         format_method = formatter.instance_method(:format)
         if !format_method || format_method.arity != 1
@@ -201,6 +213,15 @@ module Appsignal
       nil
     end
 
+    # Build any state that is otherwise built on the first formatted event.
+    # A formatter that caches something about the application overrides
+    # this.
+    #
+    # @!visibility private
+    def prefork
+      nil
+    end
+
     # @return [Integer]
     # @api public
     DEFAULT = 0
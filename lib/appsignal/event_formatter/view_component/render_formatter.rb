@@ -31,6 +31,13 @@ module Appsignal
 
           @root_path ||= "#{Rails.root}/"
         end
+
+        # The application is loaded before forking, so look up its root once
+        # in the parent process.
+        def prefork
+          root_path
+          nil
+        end
       end
     end
   end
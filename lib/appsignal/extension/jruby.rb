@@ -245,6 +245,16 @@ module Appsignal
           [:pointer],
           :appsignal_string
 
+        # Optional agent functions, only attached when the agent library
+        # provides them.
+        begin
+          attach_function :appsignal_add_transaction_error,
+            [:pointer, :appsignal_string, :appsignal_string, :pointer, :pointer],
+            :void
+        rescue FFI::NotFoundError
+          # The agent library holds a single error per transaction
+        end
+
         Appsignal.extension_loaded = true if Appsignal.respond_to? :extension_loaded=
       rescue LoadError => error
         error_message = "ERROR: AppSignal failed to load extension. " \
@@ -398,6 +408,18 @@ module Appsignal
           )
         end
 
+        if Jruby.respond_to?(:appsignal_add_transaction_error)
+          def add_error(name, message, backtrace, causes)
+            Extension.appsignal_add_transaction_error(
+              pointer,
+              make_appsignal_string(name),
+              make_appsignal_string(message),
+              backtrace.pointer,
+              causes.pointer
+            )
+          end
+        end
+
         def set_action(action_name)
           Extension.appsignal_set_transaction_action(
             pointer,
@@ -479,6 +501,13 @@ module Appsignal
           Span.new(Extension.appsignal_create_child_span(pointer))
         end
 
+        def child_with(name, attributes)
+          child.tap do |span|
+            span.set_name(name)
+            span.set_attributes(attributes)
+          end
+        end
+
         def add_error(name, message, backtrace)
           Extension.appsignal_add_span_error(
             pointer,
@@ -535,6 +564,28 @@ module Appsignal
           )
         end
 
+        def set_attributes(attributes)
+          attributes.each do |key, value|
+            key = key.to_s
+            case value
+            when String
+              set_attribute_string(key, value)
+            when Integer
+              if value.bit_length < 64
+                set_attribute_int(key, value)
+              else
+                set_attribute_string(key, "bigint:#{value}")
+              end
+            when TrueClass, FalseClass
+              set_attribute_bool(key, value)
+            when Float
+              set_attribute_double(key, value)
+            else
+              raise TypeError, "value needs to be a string, int, bool or float"
+            end
+          end
+        end
+
         def to_json # rubocop:disable Lint/ToJSON
           json = Extension.appsignal_span_to_json(pointer)
           make_ruby_string(json) if json[:len] > 0
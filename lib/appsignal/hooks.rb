@@ -9,14 +9,114 @@ module Appsignal
       end
 
       def load_hooks
+        lazy = Appsignal.config && Appsignal.config[:enable_lazy_hooks]
         hooks.each do |name, hook|
-          hook.try_to_install(name)
+          if lazy && hook.pending?
+            pending_hooks[name] = hook
+          else
+            hook.try_to_install(name)
+          end
         end
+        watch_requires if pending_hooks.any?
       end
 
       def hooks
         @hooks ||= {}
       end
+
+      # Hooks of which the library isn't loaded yet, with the
+      # `enable_lazy_hooks` config option.
+      def pending_hooks
+        @pending_hooks ||= {}
+      end
+
+      # Install the pending hooks of which the library is loaded before
+      # forking, so the worker processes don't all install them on their
+      # first `require`.
+      def prefork
+        install_pending_hooks if pending_hooks.any?
+      end
+
+      # Install the pending hooks of which the library was loaded by the
+      # required file, once the outermost `require` returns. The library is
+      # only loaded completely when the outermost `require` returns, so any
+      # nested `require` is ignored.
+      #
+      # Not called anymore once all pending hooks are installed, see
+      # {.watching_requires?}.
+      def watch_require
+        depth = Thread.current[:appsignal_require_depth] || 0
+        Thread.current[:appsignal_require_depth] = depth + 1
+        result = yield
+        install_pending_hooks if depth.zero? && pending_hooks.any?
+        result
+      ensure
+        Thread.current[:appsignal_require_depth] = depth
+      end
+
+      # Are there pending hooks to install on `require`? A prepended module
+      # can't be removed again, so {RequireWatcher} checks this on every
+      # `require` and calls the original `require` directly once all pending
+      # hooks are installed.
+      #
+      # The watcher doesn't make start faster: a hook of which the library
+      # isn't loaded isn't installed on start either way. What it adds is
+      # that a library loaded after start, like a gem required in an
+      # initializer or by a Rake task, still gets its hook installed. Without
+      # lazy hooks that library is never instrumented. The watcher is only
+      # prepended with the `enable_lazy_hooks` config option and once a hook is
+      # pending, and after that costs one method call per `require`.
+      def watching_requires?
+        @watching_requires == true
+      end
+
+      private
+
+      def watch_requires
+        @pending_hooks_lock ||= Mutex.new
+        @watching_requires = true
+        return if @require_watcher_prepended
+
+        @require_watcher_prepended = true
+        Object.prepend(RequireWatcher::Private)
+        Kernel.singleton_class.prepend(RequireWatcher)
+      end
+
+      # Called from the app's `require`, so an error in a hook is logged
+      # rather than raised from the `require` call.
+      def install_pending_hooks
+        @pending_hooks_lock.synchronize do
+          pending_hooks.each do |name, hook|
+            next if hook.pending?
+
+            pending_hooks.delete(name)
+            hook.try_to_install(name)
+          end
+          @watching_requires = false if pending_hooks.empty?
+        end
+      rescue => ex
+        Appsignal.internal_logger.error(
+          "Error while installing pending hooks: #{ex.class}: #{ex.message}\n" \
+            "#{ex.backtrace.join("\n")}"
+        )
+      end
+    end
+
+    # Calls {Hooks.watch_require} on every `require` call, both `require` and
+    # `Kernel.require`, to install the pending hooks.
+    module RequireWatcher
+      def require(path)
+        return super unless Appsignal::Hooks.watching_requires?
+
+        Appsignal::Hooks.watch_require { super }
+      end
+
+      # For `require` without a receiver, which is a private method.
+      module Private
+        include RequireWatcher
+
+        private :require
+      end
     end
 
     class Hook
@@ -24,6 +124,18 @@ module Appsignal
         Appsignal::Hooks.register(name, hook.new)
       end
 
+      # The constant the hooked library defines, like `"Sidekiq"`. With the
+      # `enable_lazy_hooks` config option, the hook isn't installed on start
+      # when the constant isn't defined yet, but once a `require` defines it.
+      # Hooks without a constant are always installed on start.
+      def self.install_when_defined(constant)
+        @trigger_constant = constant
+      end
+
+      def self.trigger_constant
+        @trigger_constant
+      end
+
       def initialize
         @installed = false
       end
@@ -49,6 +161,12 @@ module Appsignal
         @installed
       end
 
+      # Is the library of this hook not loaded yet?
+      def pending?
+        trigger_constant = self.class.trigger_constant
+        trigger_constant && !constant_loaded?(trigger_constant)
+      end
+
       def dependencies_present?
         raise NotImplementedError
       end
@@ -56,6 +174,25 @@ module Appsignal
       def install
         raise NotImplementedError
       end
+
+      private
+
+      # Is the constant defined, without loading anything to find out?
+      # `Object.const_defined?` with a nested name loads every autoloaded
+      # namespace in it, which would load the library on start, or raise the
+      # LoadError of a broken autoload from the app's `require`. Look each
+      # part of the name up on its own instead, and consider a constant that
+      # is only registered to be autoloaded as not loaded yet.
+      def constant_loaded?(name)
+        name.split("::").reduce(Object) do |namespace, part|
+          return false unless namespace.is_a?(Module)
+          return false if namespace.autoload?(part)
+          return false unless namespace.const_defined?(part, false)
+
+          namespace.const_get(part, false)
+        end
+        true
+      end
     end
 
     module Helpers
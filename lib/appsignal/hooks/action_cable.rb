@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class ActionCableHook < Appsignal::Hooks::Hook
       register :action_cable
+      install_when_defined "ActionCable"
 
       REQUEST_ID = "_appsignal_action_cable.request_id"
 
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class ActionMailerHook < Appsignal::Hooks::Hook
       register :action_mailer
+      install_when_defined "ActionMailer"
 
       def dependencies_present?
         defined?(::ActionMailer)
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class ActiveJobHook < Appsignal::Hooks::Hook
       register :active_job
+      install_when_defined "ActiveJob"
 
       # This integration records the enqueue itself, as a producer event that
       # also injects trace context, and Active Job's own `enqueue.active_job`
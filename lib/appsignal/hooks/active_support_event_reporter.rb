@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class ActiveSupportEventReporterHook < Appsignal::Hooks::Hook
       register :active_support_event_reporter
+      install_when_defined "Rails"
 
       def dependencies_present?
         defined?(::Rails) &&
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class ActiveSupportNotificationsHook < Appsignal::Hooks::Hook
       register :active_support_notifications
+      install_when_defined "ActiveSupport::Notifications::Instrumenter"
 
       def dependencies_present?
         defined?(::ActiveSupport::Notifications::Instrumenter)
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class CelluloidHook < Appsignal::Hooks::Hook
       register :celluloid
+      install_when_defined "Celluloid"
 
       def dependencies_present?
         defined?(::Celluloid)
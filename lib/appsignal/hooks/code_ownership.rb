@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class CodeOwnershipHook < Appsignal::Hooks::Hook
       register :code_ownership
+      install_when_defined "CodeOwnership"
 
       def dependencies_present?
         defined?(::CodeOwnership) &&
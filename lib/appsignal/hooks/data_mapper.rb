@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class DataMapperHook < Appsignal::Hooks::Hook
       register :data_mapper
+      install_when_defined "DataMapper"
 
       def dependencies_present?
         defined?(::DataMapper) &&
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class DelayedJobHook < Appsignal::Hooks::Hook
       register :delayed_job
+      install_when_defined "Delayed::Plugin"
 
       def dependencies_present?
         defined?(::Delayed::Plugin) && Appsignal.config &&
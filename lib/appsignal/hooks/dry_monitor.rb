@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class DryMonitorHook < Appsignal::Hooks::Hook
       register :dry_monitor
+      install_when_defined "Dry::Monitor::Notifications"
 
       def dependencies_present?
         defined?(::Dry::Monitor::Notifications)
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class ExconHook < Appsignal::Hooks::Hook
       register :excon
+      install_when_defined "Excon"
 
       def dependencies_present?
         Appsignal.config && defined?(::Excon) && Appsignal.config[:instrument_excon]
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class FaradayHook < Appsignal::Hooks::Hook
       register :faraday
+      install_when_defined "Faraday"
 
       # This integration records the request itself, so Faraday's own
       # instrumentation middleware would report the same work again as a
@@ -5,6 +5,8 @@ module Appsignal
     # @!visibility private
     class GvlHook < Appsignal::Hooks::Hook
       register :gvl
+      # Not installed lazily: the gvltools gem is only loaded by this hook's
+      # `dependencies_present?`, so no `require` would ever define `GVLTools`.
 
       def dependencies_present?
         return false if Appsignal::System.jruby?
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class HttpHook < Appsignal::Hooks::Hook
       register :http_rb
+      install_when_defined "HTTP::Client"
 
       def self.http6_or_higher?
         Gem::Version.new(HTTP::VERSION) >= Gem::Version.new("6.0.0")
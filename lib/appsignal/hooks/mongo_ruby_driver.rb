@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class MongoRubyDriverHook < Appsignal::Hooks::Hook
       register :mongo_ruby_driver
+      install_when_defined "Mongo::Monitoring::Global"
 
       def dependencies_present?
         defined?(::Mongo::Monitoring::Global) && Appsignal.config &&
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class OwnershipHook < Appsignal::Hooks::Hook
       register :ownership
+      install_when_defined "Ownership"
 
       def dependencies_present?
         defined?(::Ownership) &&
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class PassengerHook < Appsignal::Hooks::Hook
       register :passenger
+      install_when_defined "PhusionPassenger"
 
       def dependencies_present?
         defined?(::PhusionPassenger)
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class PumaHook < Appsignal::Hooks::Hook
       register :puma
+      install_when_defined "Puma"
 
       def dependencies_present?
         defined?(::Puma) &&
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class QueHook < Appsignal::Hooks::Hook
       register :que
+      install_when_defined "Que::Job"
 
       def dependencies_present?
         defined?(::Que::Job) && Appsignal.config && Appsignal.config[:instrument_que]
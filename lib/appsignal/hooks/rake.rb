@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class RakeHook < Appsignal::Hooks::Hook
       register :rake
+      install_when_defined "Rake::Task"
 
       def dependencies_present?
         defined?(::Rake::Task)
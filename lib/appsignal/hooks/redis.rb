@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class RedisHook < Appsignal::Hooks::Hook
       register :redis
+      install_when_defined "Redis"
 
       def dependencies_present?
         defined?(::Redis) &&
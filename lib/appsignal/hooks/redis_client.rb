@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class RedisClientHook < Appsignal::Hooks::Hook
       register :redis_client
+      install_when_defined "RedisClient"
 
       def dependencies_present?
         defined?(::RedisClient) &&
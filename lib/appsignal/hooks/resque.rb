@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class ResqueHook < Appsignal::Hooks::Hook
       register :resque
+      install_when_defined "Resque"
 
       def dependencies_present?
         defined?(::Resque) && Appsignal.config && Appsignal.config[:instrument_resque]
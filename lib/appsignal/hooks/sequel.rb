@@ -44,6 +44,7 @@ module Appsignal
 
     class SequelHook < Appsignal::Hooks::Hook
       register :sequel
+      install_when_defined "Sequel::Database"
 
       # The query's `Sequel::Database` names both the engine it talks to and
       # the database it is connected to, neither of which the sql.sequel
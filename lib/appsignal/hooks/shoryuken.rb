@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class ShoryukenHook < Appsignal::Hooks::Hook
       register :shoryuken
+      install_when_defined "Shoryuken"
 
       def dependencies_present?
         defined?(::Shoryuken) && Appsignal.config && Appsignal.config[:instrument_shoryuken]
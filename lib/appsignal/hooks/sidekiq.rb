@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class SidekiqHook < Appsignal::Hooks::Hook
       register :sidekiq
+      install_when_defined "Sidekiq"
 
       def self.version_5_1_or_higher?
         @version_5_1_or_higher ||=
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class UnicornHook < Appsignal::Hooks::Hook
       register :unicorn
+      install_when_defined "Unicorn::Worker"
 
       def dependencies_present?
         defined?(::Unicorn::HttpServer) &&
@@ -5,6 +5,7 @@ module Appsignal
     # @!visibility private
     class WebmachineHook < Appsignal::Hooks::Hook
       register :webmachine
+      install_when_defined "Webmachine"
 
       def dependencies_present?
         defined?(::Webmachine)
@@ -4,26 +4,71 @@ module Appsignal
   module Integrations
     # @!visibility private
     module ActiveSupportNotificationsIntegration
+      # What the integration needs to know about an event name to record it,
+      # looked up once per name and formatter. See
+      # {ActiveSupportNotificationsIntegration.descriptor_for}.
+      #
+      # - `formatter`: the formatter registered for the name, or nil.
+      # - `title_formatter`: the formatter registered under exactly this name,
+      #   which gives the event its title and body, or nil. Like
+      #   {Appsignal::EventFormatter.format}, this doesn't fall back to the
+      #   String form of a Symbol name.
+      # - `record`: whether the event is recorded at all.
+      # - `kind`: the OpenTelemetry span kind the formatter declares, or nil.
+      # - `scope`: the frozen OpenTelemetry instrumentation scope, or nil.
+      # - `attributes`: whether the formatter builds OpenTelemetry attributes.
+      Descriptor = Struct.new(:formatter, :title_formatter, :record, :kind, :scope, :attributes)
+
+      # The most event names to keep descriptors for. Event names are
+      # hardcoded in the libraries that emit them, so this is only reached if
+      # an app builds names dynamically. Names past the limit get a new
+      # descriptor every time rather than growing the cache without end.
+      DESCRIPTORS_LIMIT = 1000
+      # Guards writes to the descriptors cache. Reads are not locked: the cache
+      # is a frozen Hash that is replaced, not changed, when a name is added.
+      DESCRIPTORS_LOCK = Mutex.new
+
+      @descriptors = {}.freeze
+
       class << self
         BANG = "!"
 
         def start_event(name)
-          return unless record_event?(name)
+          # Check for a transaction first: with no transaction, or a paused
+          # one, there is nothing to record and nothing needs to be allocated.
+          transaction = active_transaction
+          return unless transaction
+
+          descriptor = descriptor_for(name)
+          return unless descriptor.record
 
           # The event's formatter says what kind of work the event is, such as
           # a SQL query being an outgoing call to a database, and can name the
           # library the instrumentation is for. Both are immutable once the
           # span exists, so they have to be set here at event start.
-          #
-          # A formatter that names no library leaves the scope to be derived
-          # from the event name, which is right for everything Rails reports.
-          Appsignal::Transaction.current.start_event(
-            :opentelemetry_kind => Appsignal::EventFormatter.opentelemetry_kind(name),
-            :opentelemetry_scope =>
-              Appsignal::EventFormatter.opentelemetry_scope(name) || scope_for(name)
+          transaction.start_event(
+            :opentelemetry_kind => descriptor.kind,
+            :opentelemetry_scope => descriptor.scope
           )
         end
 
+        # The cached descriptor for an event name. A descriptor is built again
+        # when a different formatter was registered for the name since it was
+        # cached, so registering and unregistering formatters is picked up.
+        def descriptor_for(name)
+          formatter = Appsignal::EventFormatter.formatter_for(name)
+          descriptor = @descriptors[name]
+          return descriptor if descriptor && descriptor.formatter.equal?(formatter)
+
+          descriptor = build_descriptor(name, formatter)
+          DESCRIPTORS_LOCK.synchronize do
+            if @descriptors.key?(name) || @descriptors.length < DESCRIPTORS_LIMIT
+              @descriptors = @descriptors.merge(name => descriptor).freeze
+            end
+          end
+          descriptor
+        end
+
         # ActiveSupport::Notifications bridges many Rails components through this
         # one path (`sql.active_record`, `render_template.action_view`, ...), so
         # derive the instrumentation scope from the event name's group: the part
@@ -42,15 +87,20 @@ module Appsignal
         end
 
         def finish_event(name, payload = {})
-          return unless record_event?(name)
+          transaction = active_transaction
+          return unless transaction
 
-          title, body, body_format = Appsignal::EventFormatter.format(name, payload)
-          transaction = Appsignal::Transaction.current
+          descriptor = descriptor_for(name)
+          return unless descriptor.record
+
+          title, body, body_format = descriptor.title_formatter&.format(payload)
           # Set while the event's span is still open, so the attributes land on
           # the event rather than on the transaction.
-          transaction.add_opentelemetry_attributes(
-            Appsignal::EventFormatter.opentelemetry_attributes(name, payload)
-          )
+          if descriptor.attributes
+            transaction.add_opentelemetry_attributes(
+              descriptor.formatter.opentelemetry_attributes(payload)
+            )
+          end
           record_error_type(transaction, payload)
           transaction.finish_event(
             name.to_s,
@@ -77,12 +127,39 @@ module Appsignal
           )
         end
 
+        private
+
+        # The current transaction, if there is one and it is not paused.
+        #
+        # Read from the thread directly rather than through
+        # {Appsignal::Transaction.current}, as this is called for every event
+        # and should not allocate anything when there is no transaction.
+        def active_transaction
+          transaction = Thread.current[:appsignal_transaction]
+          transaction unless transaction.nil? || transaction.paused?
+        end
+
         # Events starting with a bang are internal to Rails. An event that the
         # registry says a dedicated integration records is not recorded again
-        # here. Both `start_event` and `finish_event` gate on this so the event
-        # stack stays balanced.
-        def record_event?(name)
-          name.to_s[0] != BANG && Appsignal::EventFormatter.record?(name)
+        # here. Both `start_event` and `finish_event` gate on `record` so the
+        # event stack stays balanced.
+        #
+        # A formatter that names no library leaves the scope to be derived
+        # from the event name, which is right for everything Rails reports.
+        def build_descriptor(name, formatter)
+          record = !name.to_s.start_with?(BANG) &&
+            (!formatter.respond_to?(:record?) || formatter.record?)
+          kind = formatter.opentelemetry_kind if formatter.respond_to?(:opentelemetry_kind)
+          scope = formatter.opentelemetry_scope if formatter.respond_to?(:opentelemetry_scope)
+
+          Descriptor.new(
+            formatter,
+            Appsignal::EventFormatter.formatters[name],
+            record,
+            kind,
+            (scope || scope_for(name))&.freeze,
+            formatter.respond_to?(:opentelemetry_attributes)
+          ).freeze
         end
       end
 
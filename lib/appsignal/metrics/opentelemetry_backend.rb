@@ -45,6 +45,11 @@ module Appsignal
           )
         end
 
+        # Create the meter before forking, see {Appsignal.prefork}.
+        def prefork
+          MUTEX.synchronize { meter }
+        end
+
         # @!visibility private
         #
         # Test-only. Drops the cached meter and instruments so the next
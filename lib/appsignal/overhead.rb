@@ -0,0 +1,89 @@
+# frozen_string_literal: true
+
+module Appsignal
+  # @!visibility private
+  #
+  # Reports the time AppSignal adds to transactions, when the
+  # `enable_overhead_accounting` config option is enabled.
+  #
+  # The extension counts the calls to and nanoseconds spent in the agent per
+  # entry point, per thread. A transaction snapshots the counters of its thread
+  # when it's created, and on completion reports the difference, together with
+  # the time spent in `Transaction#complete` and on the sample data, as the
+  # `appsignal_overhead` distribution in milliseconds, tagged with the part of
+  # AppSignal it was spent in.
+  module Overhead
+    METRIC_NAME = "appsignal_overhead"
+
+    class << self
+      def start(config)
+        # Not supported by the JRuby extension
+        supported = Appsignal::Extension.respond_to?(:thread_overhead)
+        @enabled = supported && config[:enable_overhead_accounting] == true
+        Appsignal::Extension.overhead_accounting = @enabled if supported
+      end
+
+      def enabled?
+        @enabled == true
+      end
+
+      # The calls to and time spent in every extension entry point on the
+      # current thread, as `{ :entry_point => [calls, nanoseconds] }`.
+      def snapshot
+        Appsignal::Extension.thread_overhead
+      end
+
+      # The same counters as {.snapshot}, for all threads since the start of
+      # the process.
+      def summary
+        Appsignal::Extension.overhead_summary if enabled?
+      end
+
+      def clock
+        Process.clock_gettime(Process::CLOCK_MONOTONIC, :nanosecond)
+      end
+
+      # Returns the duration of the block in nanoseconds, or nil when
+      # overhead accounting is disabled.
+      def measure
+        unless enabled?
+          yield
+          return
+        end
+
+        started_at = clock
+        yield
+        clock - started_at
+      end
+
+      # @param namespace [String]
+      # @param started_with [Hash] the {.snapshot} taken when the transaction
+      #   was created.
+      # @param durations [Hash<String, Integer>] the durations in nanoseconds
+      #   measured in Ruby, per part.
+      def report(namespace, started_with, durations)
+        # Take the snapshot first, so reporting isn't counted as overhead
+        snapshot.each do |entry_point, (calls, nanoseconds)|
+          started_calls, started_nanoseconds = started_with[entry_point]
+          next if calls == started_calls
+
+          add("extension.#{entry_point}", nanoseconds - started_nanoseconds, namespace)
+        end
+        durations.each do |part, nanoseconds|
+          add(part, nanoseconds, namespace) if nanoseconds
+        end
+      end
+
+      private
+
+      def add(part, nanoseconds, namespace)
+        Appsignal.add_distribution_value(
+          METRIC_NAME,
+          nanoseconds / 1_000_000.0,
+          :part => part,
+          :namespace => namespace
+        )
+      end
+    end
+  end
+end
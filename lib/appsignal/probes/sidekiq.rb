@@ -6,6 +6,12 @@ module Appsignal
     class SidekiqProbe
       include Helpers
 
+      # The Sidekiq versions of which the probe knows how queues are stored
+      # in Redis: a list per queue, named `queue:<name>`, with the oldest job
+      # at the end.
+      QUEUE_LAYOUT_VERSIONS =
+        (Gem::Version.new("6.0.0")...Gem::Version.new("9.0.0")).freeze
+
       class Sidekiq7Adapter
         def self.redis_info
           redis_info = nil
@@ -71,9 +77,13 @@ module Appsignal
 
       # @api private
       def call
+        started_at = Process.clock_gettime(Process::CLOCK_MONOTONIC, :float_millisecond)
         track_redis_info
-        track_stats
-        track_queues
+        stats = ::Sidekiq::Stats.new
+        track_stats(stats)
+        track_queues(stats)
+        gauge "collection_duration",
+          Process.clock_gettime(Process::CLOCK_MONOTONIC, :float_millisecond) - started_at
       end
 
       private
@@ -89,9 +99,7 @@ module Appsignal
         gauge "memory_usage_rss", redis_info["used_memory_rss"]
       end
 
-      def track_stats
-        stats = ::Sidekiq::Stats.new
-
+      def track_stats(stats)
         gauge "worker_count", stats.workers_size
         gauge "process_count", stats.processes_size
         gauge_delta :jobs_processed, stats.processed do |jobs_processed|
@@ -108,12 +116,60 @@ module Appsignal
         gauge "job_count", stats.enqueued, :status => :enqueued
       end
 
-      def track_queues
-        ::Sidekiq::Queue.all.each do |queue|
-          gauge "queue_length", queue.size, :queue => queue.name
-          # Convert latency from seconds to milliseconds
-          gauge "queue_latency", queue.latency * 1_000.0, :queue => queue.name
+      # The queue lengths are read with `Sidekiq::Stats#queues`, which reads
+      # them all in one pipelined Redis call.
+      def track_queues(stats)
+        lengths = stats.queues
+        latencies = queue_latencies(lengths.keys)
+        lengths.each do |name, size|
+          gauge "queue_length", size, :queue => name
+          gauge "queue_latency", latencies[name], :queue => name
+        end
+      end
+
+      # The latency of every queue, in milliseconds.
+      #
+      # `Sidekiq::Queue#latency` costs a Redis round trip per queue. For the
+      # Sidekiq versions in {QUEUE_LAYOUT_VERSIONS}, read the oldest job of
+      # every queue in one pipelined call instead. Sidekiq's Redis layout is
+      # not a public API, so other versions use `Sidekiq::Queue#latency`.
+      def queue_latencies(names)
+        unless QUEUE_LAYOUT_VERSIONS.cover?(Gem::Version.new(::Sidekiq::VERSION))
+          return names.to_h do |name|
+            # Convert latency from seconds to milliseconds
+            [name, ::Sidekiq::Queue.new(name).latency * 1_000.0]
+          end
+        end
+        return {} if names.empty?
+
+        oldest_jobs =
+          ::Sidekiq.redis do |connection|
+            connection.pipelined do |pipeline|
+              names.each { |name| pipeline.lrange("queue:#{name}", -1, -1) }
+            end
+          end
+        names.zip(oldest_jobs).to_h do |name, jobs|
+          [name, queue_latency(jobs.first)]
+        end
+      end
+
+      # The time the oldest job in a queue has been waiting, in milliseconds,
+      # calculated like `Sidekiq::Queue#latency` does.
+      def queue_latency(job)
+        return 0.0 unless job
+
+        enqueued_at = JSON.parse(job)["enqueued_at"]
+        return 0.0 unless enqueued_at
+
+        if enqueued_at.is_a?(Float)
+          # Sidekiq 7 and older store the time in seconds
+          (Time.now.to_f - enqueued_at) * 1_000.0
+        else
+          # Sidekiq 8 and newer store the time in milliseconds
+          (Process.clock_gettime(Process::CLOCK_REALTIME, :millisecond) - enqueued_at).to_f
         end
+      rescue JSON::ParserError
+        0.0
       end
 
       # Track a gauge metric with the `sidekiq_` prefix
@@ -25,6 +25,9 @@ module Appsignal
         # to the default scope in the backend.
         @opentelemetry_scope = options.fetch(:opentelemetry_scope, nil)
         @report_errors = options.fetch(:report_errors, DEFAULT_ERROR_REPORTING)
+        # Read from the config on the first request, as the middleware can be
+        # initialized before AppSignal is started.
+        @instrument_streaming = nil
       end
 
       def call(env)
@@ -154,11 +157,23 @@ module Appsignal
           else
             env[Appsignal::Rack::APPSIGNAL_RESPONSE_INSTRUMENTED] = true
             # Instrument response body and closing of the response body
-            Appsignal::Rack::BodyWrapper.wrap(obody, transaction)
+            Appsignal::Rack::BodyWrapper.wrap(
+              obody,
+              transaction,
+              :instrument_streaming => instrument_streaming?
+            )
           end
         [status, headers, body]
       end
 
+      def instrument_streaming?
+        if @instrument_streaming.nil?
+          @instrument_streaming =
+            Appsignal.config&.[](:enable_rack_streaming_instrumentation) == true
+        end
+        @instrument_streaming
+      end
+
       # Instrument the request fully. This is used by the top instrumentation
       # middleware in the middleware stack. Unlike
       # {#instrument_app_call} this will report any exceptions being
@@ -6,7 +6,11 @@ module Appsignal
     class BodyWrapper
       IGNORED_ERRORS = [Errno::EPIPE, Errno::ECONNRESET].freeze
 
-      def self.wrap(original_body, appsignal_transaction)
+      # @param instrument_streaming [Boolean] measure the response body
+      #   stream with {StreamMetrics}. Read from the
+      #   `enable_rack_streaming_instrumentation` config option by the
+      #   middleware that wraps the body.
+      def self.wrap(original_body, appsignal_transaction, instrument_streaming: false)
         # The logic of how Rack treats a response body differs based on which methods
         # the body responds to. This means that to support the Rack 3.x spec in full
         # we need to return a wrapper which matches the API of the wrapped body as closely
@@ -30,16 +34,25 @@ module Appsignal
           # this is not going to work since the SPEC says that if both are available,
           # `each` should be used and `call` should be ignored.
           # So for that case we can drop to our default EnumerableBodyWrapper
-          CallableBodyWrapper.new(original_body, appsignal_transaction)
+          CallableBodyWrapper.new(
+            original_body,
+            appsignal_transaction,
+            :instrument_streaming => instrument_streaming
+          )
         else
-          EnumerableBodyWrapper.new(original_body, appsignal_transaction)
+          EnumerableBodyWrapper.new(
+            original_body,
+            appsignal_transaction,
+            :instrument_streaming => instrument_streaming
+          )
         end
       end
 
-      def initialize(body, appsignal_transaction)
+      def initialize(body, appsignal_transaction, instrument_streaming: false)
         @body_already_closed = false
         @body = body
         @transaction = appsignal_transaction
+        @instrument_streaming = instrument_streaming
       end
 
       # This must be present in all Rack bodies and will be called by the serving adapter
@@ -90,6 +103,99 @@ module Appsignal
       end
     end
 
+    # Counts the chunks and bytes of a streamed response body, and the time
+    # until the first chunk, when the `enable_rack_streaming_instrumentation`
+    # config option is enabled.
+    #
+    # The clock starts when the body is iterated with `each` or `call`, not
+    # when the request starts. The time spent in the app before that is not
+    # part of the stream's duration or the time to the first chunk, hence the
+    # `iteration` in the first chunk metric names.
+    #
+    # The chunks are passed on as they are. Only the `bytesize` of String chunks
+    # is read, so tracking a chunk costs a few counter updates and no
+    # allocations.
+    #
+    # @api private
+    class StreamMetrics
+      def initialize
+        @started_at = now
+        @first_chunk_at = nil
+        @chunks = 0
+        @bytes = 0
+      end
+
+      def track(chunk)
+        @first_chunk_at ||= now
+        @chunks += 1
+        @bytes += chunk.bytesize if chunk.is_a?(String)
+      end
+
+      # Report the stream as metadata on the transaction, and as distribution
+      # metrics so they can be graphed across requests. The metrics are tagged
+      # with the namespace and action of the transaction.
+      def report(transaction)
+        duration = now - @started_at
+        tags = metric_tags(transaction)
+        transaction.set_metadata("response_body_chunks", @chunks.to_s)
+        transaction.set_metadata("response_body_bytes", @bytes.to_s)
+        transaction.set_metadata("response_body_duration_ms", duration.round(2).to_s)
+        Appsignal.add_distribution_value("response_body_size", @bytes, tags)
+        Appsignal.add_distribution_value("response_body_duration", duration, tags)
+        return unless @first_chunk_at
+
+        first_chunk = @first_chunk_at - @started_at
+        transaction.set_metadata(
+          "response_body_iteration_first_chunk_ms",
+          first_chunk.round(2).to_s
+        )
+        Appsignal.add_distribution_value("response_body_iteration_first_chunk", first_chunk, tags)
+      end
+
+      private
+
+      def metric_tags(transaction)
+        tags = { :namespace => transaction.namespace }
+        tags[:action] = transaction.action if transaction.action
+        tags
+      end
+
+      def now
+        Process.clock_gettime(Process::CLOCK_MONOTONIC, :float_millisecond)
+      end
+    end
+
+    # Wraps the stream given to a callable response body, to track the chunks
+    # written to it in {StreamMetrics}.
+    #
+    # @api private
+    class MeasuredStream
+      def initialize(stream, metrics)
+        @stream = stream
+        @metrics = metrics
+      end
+
+      def write(*chunks)
+        chunks.each { |chunk| @metrics.track(chunk) }
+        @stream.write(*chunks)
+      end
+
+      def <<(chunk)
+        @metrics.track(chunk)
+        @stream << chunk
+        self
+      end
+
+      def respond_to_missing?(method_name, include_all = false)
+        super || @stream.respond_to?(method_name, include_all)
+      end
+
+      def method_missing(method_name, *args, &block)
+        @stream.__send__(method_name, *args, &block)
+      end
+      ruby2_keywords(:method_missing) if respond_to?(:ruby2_keywords, true)
+    end
+
     # The standard Rack body wrapper which exposes "each" for iterating
     # over the response body. This is supported across all 3 major Rack
     # versions.
@@ -112,7 +218,11 @@ module Appsignal
           "Process Rack response body (#each)",
           :opentelemetry_scope => ["appsignal-ruby/rack", Appsignal::VERSION]
         ) do
-          @body.each(&blk)
+          if @instrument_streaming
+            appsignal_each_measured(&blk)
+          else
+            @body.each(&blk)
+          end
         end
       rescue *IGNORED_ERRORS # Do not report
         raise
@@ -120,6 +230,18 @@ module Appsignal
         appsignal_report_error(error)
         raise error
       end
+
+      private
+
+      def appsignal_each_measured
+        metrics = StreamMetrics.new
+        @body.each do |chunk|
+          metrics.track(chunk)
+          yield chunk
+        end
+      ensure
+        metrics&.report(@transaction)
+      end
     end
 
     # The callable response bodies are a new Rack 3.x feature, and would not work
@@ -137,7 +259,16 @@ module Appsignal
           "Process Rack response body (#call)",
           :opentelemetry_scope => ["appsignal-ruby/rack", Appsignal::VERSION]
         ) do
-          @body.call(stream)
+          if @instrument_streaming
+            metrics = StreamMetrics.new
+            begin
+              @body.call(MeasuredStream.new(stream, metrics))
+            ensure
+              metrics.report(@transaction)
+            end
+          else
+            @body.call(stream)
+          end
         end
       rescue *IGNORED_ERRORS # Do not report
         raise
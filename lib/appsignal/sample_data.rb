@@ -8,6 +8,9 @@ module Appsignal
       @accepted_type = accepted_type
       @blocks = []
       @empty = false
+      @value = nil
+      @materialized = true
+      @shared_value = nil
     end
 
     def add(data = nil, &block)
@@ -19,38 +22,38 @@ module Appsignal
       else
         log_unsupported_data_type(data)
       end
+      @materialized = false
+      @shared_value = nil
     end
 
     def set_empty_value!
       @empty = true
       @blocks.clear
+      @materialized = false
+      @shared_value = nil
     end
 
+    # The merged value of all added data.
+    #
+    # The value is calculated once and cached until more data is added. The
+    # merged value replaces the parts it was calculated from, so blocks are
+    # called only once and later calls only merge the newly added parts.
+    # The returned value is frozen, and shared with duplicates of this
+    # instance. Duplicates made before the value is calculated share it too,
+    # as long as no data is added to them: the first one to read the value
+    # calculates it for all of them.
     def value
-      value = UNSET_VALUE
-      @blocks.map! do |block_or_value|
-        new_value =
-          if block_or_value.respond_to?(:call)
-            block_or_value.call
-          else
-            block_or_value
-          end
-
-        unless accepted_type?(new_value)
-          log_unsupported_data_type(new_value)
-          next
-        end
-
-        # Before trying to merge values, convert them to Ruby classes
-        # This way we don't need to check if something is of a type often
-        value_new = convert_to_ruby_class(new_value)
-        value_original = convert_to_ruby_class(value)
+      return @value if @materialized
 
-        value = merge_values(value_original, value_new)
-        new_value
+      if @shared_value && !@shared_value.empty?
+        @value = @shared_value.first
+      else
+        @value = materialize.freeze
+        @shared_value&.push(@value)
       end
-
-      value
+      @blocks = @value.nil? ? [] : [@value]
+      @materialized = true
+      @value
     end
 
     def value?
@@ -69,17 +72,52 @@ module Appsignal
 
     attr_reader :blocks
 
+    # The value calculated by this instance or one of its duplicates, shared
+    # until data is added. Empty until the value is calculated.
+    def shared_value
+      @shared_value ||= []
+    end
+
     private
 
     UNSET_VALUE = nil
     private_constant :UNSET_VALUE
 
     # Method called by `dup` and `clone` to create a duplicate instance.
-    # Make sure the `@blocks` variable is also properly duplicated.
+    # Make sure the `@blocks` variable is also properly duplicated. The cached
+    # value is frozen, so the duplicate shares it with the original. When the
+    # value isn't calculated yet, the duplicate shares the value the original
+    # or another duplicate calculates first.
     def initialize_copy(original)
       super
 
       @blocks = original.blocks.dup
+      @shared_value = original.shared_value unless @materialized
+    end
+
+    # Merge all parts in one pass. The first value is copied, and the other
+    # values are merged into that copy in place, so every part is only copied
+    # once.
+    def materialize
+      value = UNSET_VALUE
+      @blocks.each do |block_or_value|
+        new_value =
+          if block_or_value.respond_to?(:call)
+            block_or_value.call
+          else
+            block_or_value
+          end
+
+        unless accepted_type?(new_value)
+          log_unsupported_data_type(new_value)
+          next
+        end
+
+        # Before trying to merge values, convert them to Ruby classes
+        # This way we don't need to check if something is of a type often
+        value = merge_values(value, convert_to_ruby_class(new_value))
+      end
+      value
     end
 
     def accepted_type?(value)
@@ -94,8 +132,10 @@ module Appsignal
       value_new.instance_of?(value_original.class)
     end
 
+    # Merge the new value into the original value. The original value is
+    # always a copy made by this method, so it can be changed in place.
     def merge_values(value_original, value_new)
-      return value_new if value_original == UNSET_VALUE
+      return value_new.dup if value_original == UNSET_VALUE
 
       unless mergable?(value_original, value_new)
         Appsignal.internal_logger.warn(
@@ -103,14 +143,14 @@ module Appsignal
             "'#{value_original.class}' to '#{value_new.class}'. " \
             "These types can not be merged. Using new '#{value_new.class}' type."
         )
-        return value_new
+        return value_new.dup
       end
 
       case value_original
       when Hash
-        value_original.merge(value_new)
+        value_original.merge!(value_new)
       when Array
-        value_original + value_new
+        value_original.concat(value_new)
       else
         value_new
       end
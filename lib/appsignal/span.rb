@@ -11,6 +11,12 @@ module Appsignal
       Span.new(nil, @ext.child)
     end
 
+    # Create a child span with a name and attributes in one call to the
+    # extension. See {#set_attributes} for the supported attribute values.
+    def child_with(name, attributes = {})
+      Span.new(nil, @ext.child_with(name, attributes))
+    end
+
     def name=(value)
       @ext.set_name(value)
     end
@@ -59,6 +65,13 @@ module Appsignal
       end
     end
 
+    # Set multiple attributes in one call to the extension, instead of one
+    # call per attribute with {#[]=}. Supports the same values as {#[]=} and
+    # raises a TypeError for other values.
+    def set_attributes(attributes)
+      @ext.set_attributes(attributes)
+    end
+
     def to_h
       json = @ext.to_json
       return unless json
@@ -22,6 +22,17 @@ module Appsignal
     ERROR_CAUSES_LIMIT = 10
     # @!visibility private
     ERRORS_LIMIT = 10
+    # The most bytes of sample data a single key (params, session data, ...)
+    # is reported with. See {Appsignal::Utils::Data::Budget}.
+    # @!visibility private
+    SAMPLE_DATA_KEY_BYTES_LIMIT = 512 * 1024
+    # The most bytes of sample data reported per transaction, for all keys
+    # combined.
+    # @!visibility private
+    SAMPLE_DATA_BYTES_LIMIT = 2 * 1024 * 1024
+    # How deeply Hashes and Arrays in sample data may be nested.
+    # @!visibility private
+    SAMPLE_DATA_DEPTH_LIMIT = 32
     # Guards the process-wide `add_params`/`set_params` deprecation warn-once
     # flag, which transactions touch concurrently on threaded servers. A
     # constant so it is created once at load time rather than lazily.
@@ -119,6 +130,16 @@ module Appsignal
         @before_complete << block
       end
 
+      # Create the hook lists before forking, see {Appsignal.prefork}. They're
+      # otherwise created by the first transaction of every worker process.
+      #
+      # @!visibility private
+      def prefork
+        after_create
+        before_complete
+        nil
+      end
+
       # @!visibility private
       def set_current_transaction(transaction)
         Thread.current[:appsignal_transaction] = transaction
@@ -142,7 +163,7 @@ module Appsignal
       # @see .current?
       # @return [Appsignal::Transaction, Appsignal::Transaction::NilTransaction]
       def current
-        Thread.current[:appsignal_transaction] || NilTransaction.new
+        Thread.current[:appsignal_transaction] || NIL_TRANSACTION
       end
 
       # Returns if any transaction is currently active or not. A
@@ -268,6 +289,8 @@ module Appsignal
       @params_buckets = @params_mapping.values.uniq.to_h do |bucket|
         [bucket, Appsignal::SampleData.new(bucket)]
       end
+      @overhead_snapshot = Appsignal::Overhead.snapshot if Appsignal::Overhead.enabled?
+      @started_at = Appsignal::ActionHistograms.clock if Appsignal::ActionHistograms.enabled?
 
       run_after_create_hooks
     end
@@ -308,6 +331,8 @@ module Appsignal
         return
       end
 
+      complete_started_at = Appsignal::Overhead.clock if @overhead_snapshot
+
       # If the transaction is a duplicate, we don't want to finish it,
       # because we want its finish time to be the finish time of the
       # original transaction.
@@ -324,10 +349,12 @@ module Appsignal
 
       run_before_complete_hooks
 
-      sample_data if should_sample
+      sample_data_duration = Appsignal::Overhead.measure { sample_data } if should_sample
 
       @completed = true
       @backend.complete
+      record_action_duration if @started_at
+      report_overhead(complete_started_at, sample_data_duration) if complete_started_at
     end
 
     # @!visibility private
@@ -816,7 +843,7 @@ module Appsignal
     # @!visibility private
     def set_metadata(key, value)
       return unless key && value
-      return if Appsignal.config[:filter_metadata].include?(key.to_s)
+      return if Appsignal.config.snapshot.filter_metadata.include?(key)
 
       @backend.set_metadata(key, value)
     end
@@ -1001,15 +1028,16 @@ module Appsignal
         _set_error(error)
       elsif is_new_error && @backend.supports_multiple_errors?
         # Record additional errors immediately so each exception event lands on
-        # the span current now, not the root span at completion. The agent
-        # backend instead reports extras as duplicate transactions.
+        # the span current now, not the root span at completion. An agent
+        # backend without multiple error support instead reports extras as
+        # duplicate transactions.
         _send_error_to_backend(error)
       end
 
       @errors.add(error)
 
       if @backend.supports_multiple_errors?
-        # Collector mode: the error is already recorded, so run its block now
+        # Eager mode: the error is already recorded, so run its block now
         # rather than at completion. Anything a block attaches to the current
         # span -- breadcrumbs, nested errors, custom instrumentation -- then
         # lands where the error was reported, not on the root span at
@@ -1100,21 +1128,21 @@ module Appsignal
 
     # Reports the errors stored on the transaction at completion.
     #
-    # In eager (collector) mode nothing is left to do: each error was recorded
-    # and its block run when the error was added. In deferred (agent) mode the
-    # extension holds a single error, so the primary error's blocks run on this
-    # transaction and every additional error is reported as a duplicate
-    # transaction.
+    # In eager mode (collector mode, or an agent that supports multiple
+    # errors) nothing is left to do: each error was recorded and its block run
+    # when the error was added. In deferred (agent) mode the extension holds a
+    # single error, so the primary error's blocks run on this transaction and
+    # every additional error is reported as a duplicate transaction.
     def report_errors
       return if @backend.supports_multiple_errors?
 
       report_errors_as_duplicates
     end
 
-    # Agent-only legacy path. The extension transaction holds a single error, so
-    # extra errors are reported as duplicate transactions. This whole method
-    # disappears once agent mode is dropped: collector mode records every error
-    # eagerly and leaves nothing to do at completion.
+    # Agent-only legacy path, for agents whose transactions hold a single
+    # error: extra errors are reported as duplicate transactions. This whole
+    # method disappears once agent mode is dropped: collector mode records
+    # every error eagerly and leaves nothing to do at completion.
     def report_errors_as_duplicates
       @errors.each do |error|
         # Ignore the error that is already set in this transaction.
@@ -1144,6 +1172,35 @@ module Appsignal
       end
     end
 
+    # Report the overhead of this transaction, not of its duplicates, which
+    # are part of completing this transaction.
+    #
+    # The extension counts the overhead per thread, not per fiber. Fibers
+    # that run on the same thread as this transaction, like other
+    # transactions on a fiber-based server, add their overhead to it too.
+    def report_overhead(complete_started_at, sample_data_duration)
+      return if duplicate?
+
+      Appsignal::Overhead.report(
+        namespace,
+        @overhead_snapshot,
+        "transaction.complete" => Appsignal::Overhead.clock - complete_started_at,
+        "transaction.sample_data" => sample_data_duration
+      )
+    end
+
+    # Count the duration of this transaction for its action. Duplicates are
+    # part of the original transaction, so they're not counted.
+    def record_action_duration
+      return if duplicate? || @action.nil?
+
+      Appsignal::ActionHistograms.record(
+        @namespace,
+        @action,
+        Appsignal::ActionHistograms.clock - @started_at
+      )
+    end
+
     def _set_error(error)
       @error_set = error
       _send_error_to_backend(error)
@@ -1153,7 +1210,8 @@ module Appsignal
     # neutral data ({name, message, backtrace}); each backend projects what it
     # needs -- the agent's first-line `error_causes` sample data, or the
     # OpenTelemetry `appsignal.error_causes` attribute. Called for the first
-    # error and, in collector mode, for each additional error as it is added.
+    # error and, when the backend supports multiple errors, for each additional
+    # error as it is added.
     def _send_error_to_backend(error)
       causes, root_cause_missing = _error_causes(error)
       @backend.set_error(
@@ -1240,6 +1298,9 @@ module Appsignal
       end
     end
 
+    # The sample data is copied, not calculated. The copies share the value
+    # that the original or a duplicate calculates first, see
+    # {SampleData#value}.
     def duplicate
       new_transaction_id = SecureRandom.uuid
       self.class.new(
@@ -1263,8 +1324,11 @@ module Appsignal
     def sanitized_params(sample = params_data(:params))
       return unless Appsignal.config[:send_params]
 
-      filter_keys = Appsignal.config[:filter_parameters] || []
-      Appsignal::Utils::SampleDataSanitizer.sanitize(params_value(sample), filter_keys)
+      Appsignal::Utils::SampleDataSanitizer.sanitize(
+        params_value(sample),
+        Appsignal.config.snapshot.filter_parameters,
+        sample_data_budget
+      )
     end
 
     # Reads a params bucket's value. Evaluating it runs any block the caller
@@ -1301,10 +1365,18 @@ module Appsignal
 
       Appsignal::Utils::SampleDataSanitizer.sanitize(
         session_data,
-        Appsignal.config[:filter_session_data]
+        Appsignal.config.snapshot.filter_session_data,
+        sample_data_budget
       )
     end
 
+    # Params and session data are cut short to the limit per key while they
+    # are sanitized, so a large payload isn't copied in full. The limit per
+    # transaction is applied by the backend.
+    def sample_data_budget
+      Appsignal::Utils::Data::Budget.new(SAMPLE_DATA_KEY_BYTES_LIMIT, SAMPLE_DATA_DEPTH_LIMIT)
+    end
+
     def request_headers
       @headers.value
     rescue => e
@@ -1399,5 +1471,9 @@ module Appsignal
         true
       end
     end
+
+    # A NilTransaction has no state, so {Transaction.current} returns this one
+    # rather than allocating a new one every time there is no transaction.
+    NIL_TRANSACTION = NilTransaction.new
   end
 end
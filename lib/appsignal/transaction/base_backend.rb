@@ -73,8 +73,9 @@ module Appsignal
       end
 
       # Whether the backend can hold more than one error on a single
-      # transaction. When it can't (agent mode), the Transaction reports the
-      # extra errors as duplicate transactions instead.
+      # transaction. When it can't (agent mode with an agent that doesn't
+      # support it), the Transaction reports the extra errors as duplicate
+      # transactions instead.
       def supports_multiple_errors?
         raise NotImplementedError
       end
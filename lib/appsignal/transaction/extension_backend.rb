@@ -40,6 +40,9 @@ module Appsignal
           Appsignal::Extension.start_transaction(transaction_id, namespace, 0) ||
           Appsignal::Extension::MockTransaction.new
         @breadcrumbs = []
+        @error_set = false
+        @sample_data_bytes = 0
+        @sample_data_truncated = false
       end
       # rubocop:enable Metrics/ParameterLists, Lint/UnusedMethodArgument
 
@@ -98,8 +101,26 @@ module Appsignal
 
       # `data` is a raw Ruby Hash/Array; the C extension wants a `Data` object,
       # so serialize it here (mirrors how `set_error` serializes its backtrace).
+      #
+      # The serialization is bounded per key and per transaction, so a huge
+      # request payload is cut short while it is serialized rather than copied
+      # in full. Whatever doesn't fit is replaced with a truncation marker.
       def set_sample_data(key, data)
-        @handle.set_sample_data(key, Appsignal::Utils::Data.generate(data))
+        budget = Appsignal::Utils::Data::Budget.new(
+          [
+            Appsignal::Transaction::SAMPLE_DATA_KEY_BYTES_LIMIT,
+            Appsignal::Transaction::SAMPLE_DATA_BYTES_LIMIT - @sample_data_bytes
+          ].min,
+          Appsignal::Transaction::SAMPLE_DATA_DEPTH_LIMIT
+        )
+        @handle.set_sample_data(key, Appsignal::Utils::Data.generate(data, budget))
+        @sample_data_bytes += budget.bytes_used
+        return unless budget.truncated?
+
+        @sample_data_truncated = true
+        Appsignal.internal_logger.debug(
+          "Sample data '#{key}' is too big or too deeply nested and was truncated"
+        )
       end
 
       # Buffer breadcrumbs, keeping the last `BREADCRUMB_LIMIT`, and flush them as
@@ -112,6 +133,9 @@ module Appsignal
       # Serializes the backtrace to a C-extension `Data` object and records the
       # error, then flushes the causes as `error_causes` sample data in the
       # agent's first-line shape.
+      #
+      # When the agent supports multiple errors, every error after the first is
+      # added to the same extension transaction, with its own causes, instead.
       def set_error(class_name, message, backtrace, causes, root_cause_missing)
         backtrace_data =
           if backtrace
@@ -119,9 +143,21 @@ module Appsignal
           else
             Appsignal::Extension.data_array_new
           end
-        @handle.set_error(class_name, message, backtrace_data)
+        causes_sample_data = error_causes_sample_data(causes, root_cause_missing)
+
+        if @error_set
+          @handle.add_error(
+            class_name,
+            message,
+            backtrace_data,
+            Appsignal::Utils::Data.generate(causes_sample_data)
+          )
+          return
+        end
 
-        set_sample_data("error_causes", error_causes_sample_data(causes, root_cause_missing))
+        @error_set = true
+        @handle.set_error(class_name, message, backtrace_data)
+        set_sample_data("error_causes", causes_sample_data)
       end
 
       def finish
@@ -129,8 +165,11 @@ module Appsignal
       end
 
       def complete
-        unless @breadcrumbs.empty?
-          @handle.set_sample_data("breadcrumbs", Appsignal::Utils::Data.generate(@breadcrumbs))
+        set_sample_data("breadcrumbs", @breadcrumbs) unless @breadcrumbs.empty?
+        if @sample_data_truncated
+          Appsignal::Metrics::ExtensionBackend.increment_counter(
+            "appsignal_truncated_transactions", 1, {}
+          )
         end
         @handle.complete
       end
@@ -143,10 +182,11 @@ module Appsignal
       def discard
       end
 
-      # The extension transaction holds a single error, so the Transaction
-      # reports additional errors as duplicate transactions instead.
+      # The extension transaction holds more than one error when the agent
+      # library provides `add_error`. When it doesn't, the Transaction reports
+      # additional errors as duplicate transactions instead.
       def supports_multiple_errors?
-        false
+        @handle.respond_to?(:add_error)
       end
 
       def duplicate(new_transaction_id)
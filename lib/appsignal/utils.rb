@@ -9,6 +9,7 @@ end
 require "appsignal/utils/integration_memory_logger"
 require "appsignal/utils/stdout_and_logger_message"
 require "appsignal/utils/data"
+require "appsignal/utils/key_filter"
 require "appsignal/utils/sample_data_sanitizer"
 require "appsignal/utils/integration_logger"
 require "appsignal/utils/json"
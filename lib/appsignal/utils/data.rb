@@ -3,21 +3,101 @@
 module Appsignal
   module Utils
     class Data
+      # Value put in place of the data that didn't fit in a {Budget}.
+      TRUNCATED = "[TRUNCATED]"
+      # Nominal size of a value that isn't a String, like an Integer or nil.
+      SCALAR_BYTESIZE = 8
+
+      # Limits how much data `generate` writes into an extension `Data` object.
+      #
+      # The budget is spent while the `Data` object is built, so a value that
+      # doesn't fit stops the walk over the rest of the Hash or Array, rather
+      # than building the full `Data` object first and trimming it afterwards.
+      # The sizes are an estimate of the serialized size: the byte size of
+      # every key and String value, {SCALAR_BYTESIZE} for numbers, booleans
+      # and nil, and the byte size of `to_s` for other values, which are
+      # written as Strings.
+      #
+      # {SampleDataSanitizer} spends a budget too, so params and session data
+      # are cut short before they are copied. The {TRUNCATED} marker it puts
+      # in their place marks the budget of `generate` as truncated.
+      #
+      # @!visibility private
+      class Budget
+        attr_reader :bytes_used
+
+        def initialize(max_bytes, max_depth)
+          @max_bytes = max_bytes
+          @max_depth = max_depth
+          @bytes_used = 0
+          @exhausted = false
+          @truncated = false
+        end
+
+        # Spend the given number of bytes. Returns false, and stops any
+        # further spending, if they don't fit in the remaining budget.
+        def spend(bytes)
+          return false if @exhausted
+
+          if @bytes_used + bytes > @max_bytes
+            @exhausted = true
+            @truncated = true
+            return false
+          end
+
+          @bytes_used += bytes
+          true
+        end
+
+        # Returns false, and marks the data as truncated, if a Hash or Array
+        # at the given nesting depth is nested too deeply.
+        def depth?(depth)
+          return true if depth <= @max_depth
+
+          @truncated = true
+          false
+        end
+
+        # Mark the data as truncated, without spending the budget.
+        def truncated!
+          @truncated = true
+        end
+
+        def exhausted?
+          @exhausted
+        end
+
+        def truncated?
+          @truncated
+        end
+      end
+
       class << self
-        def generate(body)
+        def generate(body, budget = nil)
           if body.is_a?(Hash)
-            map_hash(body)
+            map_hash(body, budget)
           elsif body.is_a?(Array)
-            map_array(body)
+            map_array(body, budget)
           else
             raise TypeError, "Body of type #{body.class} should be a Hash or Array"
           end
         end
 
-        def map_hash(hash_value)
+        def map_hash(hash_value, budget = nil, depth = 1)
           map = Appsignal::Extension.data_map_new
           hash_value.each do |key, value|
             key = key.to_s
+            if budget
+              break if budget.exhausted?
+
+              value = budgeted_value(value, budget)
+
+              unless budget.spend(key.bytesize + value_bytesize(value))
+                map.set_string(key, TRUNCATED)
+                break
+              end
+            end
+
             case value
             when String
               map.set_string(key, value)
@@ -36,9 +116,17 @@ module Appsignal
             when NilClass
               map.set_nil(key)
             when Hash
-              map.set_data(key, map_hash(value))
+              if budget && !budget.depth?(depth + 1)
+                map.set_string(key, TRUNCATED)
+              else
+                map.set_data(key, map_hash(value, budget, depth + 1))
+              end
             when Array
-              map.set_data(key, map_array(value))
+              if budget && !budget.depth?(depth + 1)
+                map.set_string(key, TRUNCATED)
+              else
+                map.set_data(key, map_array(value, budget, depth + 1))
+              end
             else
               map.set_string(key, value.to_s)
             end
@@ -46,9 +134,20 @@ module Appsignal
           map
         end
 
-        def map_array(array_value)
+        def map_array(array_value, budget = nil, depth = 1)
           array = Appsignal::Extension.data_array_new
           array_value.each do |value|
+            if budget
+              break if budget.exhausted?
+
+              value = budgeted_value(value, budget)
+
+              unless budget.spend(value_bytesize(value))
+                array.append_string(TRUNCATED)
+                break
+              end
+            end
+
             case value
             when String
               array.append_string(value)
@@ -67,9 +166,17 @@ module Appsignal
             when NilClass
               array.append_nil
             when Hash
-              array.append_data(map_hash(value))
+              if budget && !budget.depth?(depth + 1)
+                array.append_string(TRUNCATED)
+              else
+                array.append_data(map_hash(value, budget, depth + 1))
+              end
             when Array
-              array.append_data(map_array(value))
+              if budget && !budget.depth?(depth + 1)
+                array.append_string(TRUNCATED)
+              else
+                array.append_data(map_array(value, budget, depth + 1))
+              end
             else
               array.append_string(value.to_s)
             end
@@ -80,6 +187,38 @@ module Appsignal
         def map_bigint(value)
           "bigint:#{value}"
         end
+
+        # The bytes a value costs when it is written, not counting the values
+        # nested in it, which are spent as they are walked.
+        #
+        # @!visibility private
+        def value_bytesize(value)
+          case value
+          when String
+            value.bytesize
+          when Integer, Float, TrueClass, FalseClass, NilClass, Hash, Array
+            SCALAR_BYTESIZE
+          else
+            value.to_s.bytesize
+          end
+        end
+
+        private
+
+        # Values that are written as Strings are converted once, so their
+        # size is spent and written from the same String.
+        def budgeted_value(value, budget)
+          case value
+          when String
+            # The marker of data that was cut short by the sanitizer
+            budget.truncated! if value.equal?(TRUNCATED)
+            value
+          when Integer, Float, TrueClass, FalseClass, NilClass, Hash, Array
+            value
+          else
+            value.to_s
+          end
+        end
       end
     end
   end
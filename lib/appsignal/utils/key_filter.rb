@@ -0,0 +1,36 @@
+# frozen_string_literal: true
+
+module Appsignal
+  module Utils
+    # Matches keys against a list of key names from the config, like the
+    # `filter_parameters` config option.
+    #
+    # A key matches if its String form is in the list, so both the `"password"`
+    # String and the `:password` Symbol match `"password"`. String and Symbol
+    # keys are looked up as is, without converting them to a String first.
+    #
+    # @!visibility private
+    class KeyFilter
+      def initialize(keys)
+        names = keys.map(&:to_s)
+        @keys = (names + names.map(&:to_sym)).to_h { |key| [key, true] }.freeze
+        freeze
+      end
+
+      def include?(key)
+        return false if @keys.empty?
+
+        case key
+        when String, Symbol
+          @keys.key?(key)
+        else
+          @keys.key?(key.to_s)
+        end
+      end
+
+      def empty?
+        @keys.empty?
+      end
+    end
+  end
+end
@@ -4,10 +4,52 @@ module Appsignal
   module Utils
     class QueryParamsSanitizer
       REPLACEMENT_KEY = "?"
+      # The number of sanitized query shapes to cache. When full, the least
+      # recently used shape is removed.
+      CACHE_LIMIT = 1000
+      # Guards the cache of sanitized query shapes. Created once at load time
+      # rather than lazily, so two threads can't each create a lock of their
+      # own.
+      CACHE_LOCK = Mutex.new
 
       module ClassMethods
+        # Sanitize the params of a query.
+        #
+        # Queries with the same shape, the same keys with the same nesting of
+        # Hashes and Arrays, have the same sanitized result. With the C
+        # extension loaded, the result is cached per shape and shared by
+        # queries with a shape that was sanitized before. The result is
+        # frozen, whether it was cached or not.
+        #
         # rubocop:disable Style/OptionalBooleanParameter
         def sanitize(params, only_top_level = false, key_sanitizer = nil)
+          return REPLACEMENT_KEY unless params.is_a?(Hash) || params.is_a?(Array)
+
+          shape = query_params_shape(params, only_top_level, key_sanitizer)
+          return deep_freeze(sanitize_value(params, only_top_level, key_sanitizer)) unless shape
+
+          cached_sanitize(shape) do
+            deep_freeze(sanitize_value(params, only_top_level, key_sanitizer))
+          end
+        end
+        # rubocop:enable Style/OptionalBooleanParameter
+
+        # @!visibility private
+        def clear_cache!
+          CACHE_LOCK.synchronize { cache.clear }
+        end
+
+        # Create the cache before forking, see {Appsignal.prefork}.
+        #
+        # @!visibility private
+        def prefork
+          native_shapes?
+          cache
+        end
+
+        private
+
+        def sanitize_value(params, only_top_level, key_sanitizer)
           case params
           when Hash
             sanitize_hash params, only_top_level, key_sanitizer
@@ -17,9 +59,6 @@ module Appsignal
             REPLACEMENT_KEY
           end
         end
-        # rubocop:enable Style/OptionalBooleanParameter
-
-        private
 
         def sanitize_hash(hash, only_top_level, key_sanitizer)
           {}.tap do |h|
@@ -28,7 +67,7 @@ module Appsignal
                 if only_top_level
                   REPLACEMENT_KEY
                 else
-                  sanitize(value, only_top_level, key_sanitizer)
+                  sanitize_value(value, only_top_level, key_sanitizer)
                 end
             end
           end
@@ -36,10 +75,10 @@ module Appsignal
 
         def sanitize_array(array, only_top_level, key_sanitizer)
           if only_top_level
-            [sanitize(array[0], only_top_level, key_sanitizer)]
+            [sanitize_value(array[0], only_top_level, key_sanitizer)]
           else
             array.map do |value|
-              sanitize(value, only_top_level, key_sanitizer)
+              sanitize_value(value, only_top_level, key_sanitizer)
             end.uniq
           end
         end
@@ -50,6 +89,59 @@ module Appsignal
           else key
           end
         end
+
+        # The shape of the params, written out by the C extension as a String
+        # with every key in it, or nil if the params can't be cached by shape
+        # or the extension isn't loaded. The cache is keyed by the full shape,
+        # so two queries only share a result when their shapes are equal.
+        def query_params_shape(params, only_top_level, key_sanitizer)
+          return unless native_shapes?
+
+          Appsignal::Extension.query_params_shape(
+            params,
+            only_top_level,
+            key_sanitizer == :mongodb
+          )
+        end
+
+        def native_shapes?
+          if @native_shapes.nil?
+            @native_shapes = Appsignal::Extension.respond_to?(:query_params_shape)
+          end
+          @native_shapes
+        end
+
+        # Return the cached result for the shape, or cache the result of the
+        # block. The cache Hash is ordered by use: a hit moves the shape to
+        # the end, and when full the first shape is removed.
+        def cached_sanitize(shape)
+          CACHE_LOCK.synchronize do
+            if cache.key?(shape)
+              result = cache.delete(shape)
+              cache[shape] = result
+              return result
+            end
+          end
+
+          result = yield
+          CACHE_LOCK.synchronize do
+            cache[shape] = result
+            cache.shift if cache.size > CACHE_LIMIT
+          end
+          result
+        end
+
+        def cache
+          @cache ||= {}
+        end
+
+        def deep_freeze(value)
+          case value
+          when Hash then value.each_value { |v| deep_freeze(v) }
+          when Array then value.each { |v| deep_freeze(v) }
+          end
+          value.freeze
+        end
       end
 
       extend ClassMethods
@@ -7,18 +7,31 @@ module Appsignal
       RECURSIVE = "[RECURSIVE VALUE]"
 
       class << self
-        def sanitize(value, filter_keys = [])
-          sanitize_value(value, filter_keys, [])
+        # @param filter_keys [Array<String>, Appsignal::Utils::KeyFilter] The
+        #   keys of which to filter the values.
+        # @param budget [Appsignal::Utils::Data::Budget, nil] Stop the walk
+        #   over the value once the budget is spent, and put the
+        #   {Appsignal::Utils::Data::TRUNCATED} marker in place of the rest,
+        #   so a large value isn't copied in full.
+        def sanitize(value, filter_keys = [], budget = nil)
+          unless filter_keys.is_a?(Appsignal::Utils::KeyFilter)
+            filter_keys = Appsignal::Utils::KeyFilter.new(filter_keys)
+          end
+          sanitize_value(value, filter_keys, [], budget, 1)
         end
 
         private
 
-        def sanitize_value(value, filter_keys, seen)
+        def sanitize_value(value, filter_keys, seen, budget = nil, depth = 1)
           case value
           when Hash
-            sanitize_hash(value, filter_keys, seen)
+            return Appsignal::Utils::Data::TRUNCATED if budget && !budget.depth?(depth)
+
+            sanitize_hash(value, filter_keys, seen, budget, depth)
           when Array
-            sanitize_array(value, filter_keys, seen)
+            return Appsignal::Utils::Data::TRUNCATED if budget && !budget.depth?(depth)
+
+            sanitize_array(value, filter_keys, seen, budget, depth)
           when TrueClass, FalseClass, NilClass, Integer, String, Symbol, Float
             unmodified(value)
           when Time
@@ -44,38 +57,79 @@ module Appsignal
           end
         end
 
-        def sanitize_hash(source, filter_keys, seen)
+        def sanitize_hash(source, filter_keys, seen, budget, depth)
           seen = seen.clone << source.object_id
 
           {}.tap do |hash|
             source.each_pair do |key, value|
+              break if budget&.exhausted?
+
               hash[key] =
                 if seen.include?(value.object_id)
                   RECURSIVE
-                elsif filter_keys.include?(key.to_s)
+                elsif filter_keys.include?(key)
                   FILTERED
                 else
-                  sanitize_value(value, filter_keys, seen)
+                  sanitize_item(value, filter_keys, seen, budget, depth, key)
                 end
+              next if !budget || spent?(hash[key])
+              next if budget.spend(key.to_s.bytesize + value_bytesize(hash[key]))
+
+              hash[key] = Appsignal::Utils::Data::TRUNCATED
+              break
             end
           end
         end
 
-        def sanitize_array(source, filter_keys, seen)
+        def sanitize_array(source, filter_keys, seen, budget, depth)
           seen = seen.clone << source.object_id
 
           [].tap do |array|
             source.each_with_index do |item, index|
+              break if budget&.exhausted?
+
               array[index] =
                 if seen.include?(item.object_id)
                   RECURSIVE
                 else
-                  sanitize_value(item, filter_keys, seen)
+                  sanitize_item(item, filter_keys, seen, budget, depth)
                 end
+              next if !budget || spent?(array[index])
+              next if budget.spend(value_bytesize(array[index]))
+
+              array[index] = Appsignal::Utils::Data::TRUNCATED
+              break
             end
           end
         end
 
+        # Sanitize a value in a Hash or Array. With a budget, a nested Hash or
+        # Array spends the bytes of its key first, and its own values while
+        # they are walked, like {Appsignal::Utils::Data.generate} does.
+        def sanitize_item(value, filter_keys, seen, budget, depth, key = nil)
+          if budget && container?(value)
+            key_bytesize = key.nil? ? 0 : key.to_s.bytesize
+            unless budget.spend(key_bytesize + Appsignal::Utils::Data::SCALAR_BYTESIZE)
+              return Appsignal::Utils::Data::TRUNCATED
+            end
+          end
+          sanitize_value(value, filter_keys, seen, budget, depth + 1)
+        end
+
+        # Was the sanitized value spent by {#sanitize_item} already? Only
+        # nested Hashes and Arrays are, and those that were cut short.
+        def spent?(sanitized)
+          container?(sanitized) || sanitized.equal?(Appsignal::Utils::Data::TRUNCATED)
+        end
+
+        def container?(value)
+          value.is_a?(Hash) || value.is_a?(Array)
+        end
+
+        def value_bytesize(value)
+          Appsignal::Utils::Data.value_bytesize(value)
+        end
+
         def unmodified(value)
           value
         end
@@ -0,0 +1,89 @@
+# The JRuby extension doesn't count action durations.
+describe Appsignal::ActionHistograms, :skip => DependencyHelper.running_jruby? do
+  let(:options) do
+    { :enable_action_histograms => true, :enable_minutely_probes => false, :hostname => "my-host" }
+  end
+  let(:histograms) { [["web", "MyController#show", 3, 1.0, 2.0, 3.0, 4.0]] }
+  let(:tags) { { :namespace => "web", :action => "MyController#show", :hostname => "my-host" } }
+  # Every push to this queue ends one wait of the reporter thread
+  let(:minutes) { Queue.new }
+  before do
+    allow(described_class).to receive(:sleep) { minutes.pop }
+    allow(Appsignal).to receive(:set_gauge)
+    start_agent(:options => options)
+    Appsignal::Extension.reset_action_histograms
+  end
+
+  it "reports the completed minute from a thread of its own without the minutely probes" do
+    allow(Appsignal::Extension).to receive(:action_histograms).with(false).and_return(histograms)
+    minutes << nil
+
+    wait_for("the reporter thread to report") do
+      expect(Appsignal).to have_received(:set_gauge)
+        .with("transaction_duration_count", 3, tags)
+      expect(Appsignal).to have_received(:set_gauge)
+        .with("transaction_duration_percentile", 4.0, tags.merge(:percentile => "max"))
+    end
+    expect(Appsignal::Probes.started?).to be_falsy
+  end
+
+  it "doesn't start a reporter thread when disabled" do
+    described_class.start(:enable_action_histograms => false)
+
+    expect(described_class.reporter).to be_nil
+  end
+
+  it "reports the current minute and stops the reporter thread on stop" do
+    reporter = described_class.reporter
+    described_class.record("web", "MyController#show", 1_000_000)
+    described_class.stop
+
+    expect(Appsignal).to have_received(:set_gauge)
+      .with("transaction_duration_count", 1, tags)
+    expect(reporter.join(1)).to_not be_nil
+    expect(described_class.reporter).to be_nil
+    expect(described_class).to_not be_enabled
+  end
+
+  describe ".forked" do
+    before do
+      allow(Appsignal).to receive(:_start_logger)
+      allow(Appsignal::Extension).to receive(:start)
+    end
+
+    it "starts a reporter thread for the forked process" do
+      reporter = described_class.reporter
+      Appsignal.forked
+
+      expect(described_class.reporter).to_not equal(reporter)
+      expect(described_class.reporter).to be_alive
+    end
+
+    it "reports from the forked process" do
+      reader, writer = IO.pipe
+      reported = Queue.new
+      allow(Appsignal).to receive(:set_gauge) do |name, _value, _tags|
+        writer.puts("#{name} #{Process.pid}")
+        reported << name
+      end
+      allow(Appsignal::Extension).to receive(:action_histograms).with(false).and_return(histograms)
+
+      pid = Process.fork do
+        reader.close
+        Appsignal.forked
+        minutes << nil
+        Timeout.timeout(5) { reported.pop }
+        exit!(0)
+      rescue Exception # rubocop:disable Lint/RescueException
+        exit!(1)
+      end
+      writer.close
+      Process.wait(pid)
+
+      expect($?.exitstatus).to eq(0)
+      expect(reader.read).to include("transaction_duration_count #{pid}")
+    ensure
+      reader&.close
+    end
+  end
+end
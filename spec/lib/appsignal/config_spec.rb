@@ -724,6 +724,10 @@ describe Appsignal::Config do
         :enable_rails_error_reporter => false,
         :enable_active_support_event_log_reporter => false,
         :enable_rake_performance_instrumentation => false,
+        :enable_rack_streaming_instrumentation => false,
+        :enable_lazy_hooks => false,
+        :enable_overhead_accounting => false,
+        :enable_action_histograms => false,
         :enable_statsd => false,
         :endpoint => "https://test.appsignal.com",
         :files_world_accessible => false,
@@ -818,6 +822,10 @@ describe Appsignal::Config do
         "APPSIGNAL_ENABLE_RAILS_ERROR_REPORTER" => "false",
         "APPSIGNAL_ENABLE_ACTIVE_SUPPORT_EVENT_LOG_REPORTER" => "false",
         "APPSIGNAL_ENABLE_RAKE_PERFORMANCE_INSTRUMENTATION" => "false",
+        "APPSIGNAL_ENABLE_RACK_STREAMING_INSTRUMENTATION" => "false",
+        "APPSIGNAL_ENABLE_LAZY_HOOKS" => "false",
+        "APPSIGNAL_ENABLE_OVERHEAD_ACCOUNTING" => "false",
+        "APPSIGNAL_ENABLE_ACTION_HISTOGRAMS" => "false",
         "APPSIGNAL_ENABLE_STATSD" => "false",
         "APPSIGNAL_FILES_WORLD_ACCESSIBLE" => "false",
         "APPSIGNAL_INSTRUMENT_ACTIVE_JOB" => "false",
@@ -972,6 +980,10 @@ describe Appsignal::Config do
         :enable_rails_error_reporter    => true,
         :enable_active_support_event_log_reporter => false,
         :enable_rake_performance_instrumentation => false,
+        :enable_rack_streaming_instrumentation => false,
+        :enable_lazy_hooks              => false,
+        :enable_overhead_accounting     => false,
+        :enable_action_histograms       => false,
         :endpoint                       => "https://push.appsignal.com",
         :files_world_accessible         => true,
         :filter_attributes              => [],
@@ -1666,6 +1678,52 @@ describe Appsignal::Config do
     end
   end
 
+  describe "#snapshot" do
+    let(:config) do
+      build_config(:options => { :filter_parameters => ["password"], :filter_metadata => ["key"] })
+    end
+
+    it "compiles the filter options" do
+      snapshot = config.snapshot
+
+      expect(snapshot.filter_parameters.include?("password")).to be(true)
+      expect(snapshot.filter_parameters.include?(:password)).to be(true)
+      expect(snapshot.filter_parameters.include?("email")).to be(false)
+      expect(snapshot.filter_metadata.include?("key")).to be(true)
+      expect(snapshot.filter_session_data).to be_empty
+      expect(snapshot).to be_frozen
+    end
+
+    it "returns the same snapshot until an option is set" do
+      snapshot = config.snapshot
+
+      expect(config.snapshot).to equal(snapshot)
+    end
+
+    it "returns a new snapshot with the latest options after an option is set" do
+      snapshot = config.snapshot
+      config[:filter_parameters] = ["email"]
+
+      expect(config.snapshot).to_not equal(snapshot)
+      expect(config.snapshot.filter_parameters.include?("email")).to be(true)
+    end
+
+    it "returns a new snapshot with the latest options after DSL options are merged" do
+      snapshot = config.snapshot
+      config.merge_dsl_options(:filter_session_data => ["token"])
+
+      expect(config.snapshot).to_not equal(snapshot)
+      expect(config.snapshot.filter_session_data.include?("token")).to be(true)
+    end
+
+    it "returns the same snapshot once the config is frozen" do
+      config.freeze
+
+      expect(config.snapshot).to equal(config.snapshot)
+      expect(config.snapshot.filter_parameters.include?("password")).to be(true)
+    end
+  end
+
   describe "#collector_mode_configured?" do
     let(:options) { {} }
     let(:config) { build_config(:root_path => "", :env => nil, :options => options) }
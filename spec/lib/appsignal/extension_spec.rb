@@ -24,6 +24,50 @@ describe Appsignal::Extension do
     it { is_expected.to be_kind_of(Integer) }
   end
 
+  # The JRuby extension doesn't count action durations.
+  describe ".action_histograms", :if => !DependencyHelper.running_jruby? do
+    before { Appsignal::Extension.reset_action_histograms }
+    after { Appsignal::Extension.reset_action_histograms }
+
+    it "returns the percentiles per action in milliseconds" do
+      (1..1000).to_a.shuffle.each do |ms|
+        Appsignal::Extension.record_action_duration("web", "MyController#show", ms * 1_000_000)
+      end
+      Appsignal::Extension.record_action_duration("background_job", "MyJob", 30_000)
+
+      histograms = Appsignal::Extension.action_histograms(true)
+
+      expect(histograms.length).to eq(2)
+      web = histograms.find { |namespace, _| namespace == "web" }
+      namespace, action, count, p50, p95, p99, max = web
+      expect([namespace, action, count]).to eq(["web", "MyController#show", 1000])
+      expect(p50).to be_within(500 * 0.04).of(500)
+      expect(p95).to be_within(950 * 0.04).of(950)
+      expect(p99).to be_within(990 * 0.04).of(990)
+      expect(max).to eq(1000.0)
+      expect(histograms).to include(["background_job", "MyJob", 1, 0.03, 0.03, 0.03, 0.03])
+    end
+
+    it "clears the returned durations" do
+      Appsignal::Extension.record_action_duration("web", "MyController#show", 1_000_000)
+      Appsignal::Extension.action_histograms(true)
+
+      expect(Appsignal::Extension.action_histograms(true)).to eq([])
+    end
+
+    it "doesn't return the current minute by default" do
+      Appsignal::Extension.record_action_duration("web", "MyController#show", 1_000_000)
+
+      expect(Appsignal::Extension.action_histograms(false)).to eq([])
+    end
+
+    it "ignores actions that aren't Strings" do
+      Appsignal::Extension.record_action_duration("web", nil, 1_000_000)
+
+      expect(Appsignal::Extension.action_histograms(true)).to eq([])
+    end
+  end
+
   context "when the extension library can be loaded" do
     subject { Appsignal::Extension }
 
@@ -20,6 +20,15 @@ shared_examples "activesupport instrument override" do
       )
     end
 
+    it "formats the event with the formatter from the descriptor", :agent_mode do
+      start_agent
+      set_current_transaction(http_request_transaction)
+      as.notifier = notifier
+      expect(Appsignal::EventFormatter).to_not receive(:format)
+
+      expect(perform).to eq "value"
+    end
+
     it "in collector mode", :collector_mode do
       start_collector_agent
       transaction = http_request_transaction
@@ -45,6 +54,26 @@ shared_examples "activesupport instrument override" do
     end
   end
 
+  describe "an event with a Symbol name" do
+    def perform
+      as.instrument(:"sql.active_record", :sql => "SQL") { "value" }
+    end
+
+    it "doesn't format the event with the formatter for the String name", :agent_mode do
+      start_agent
+      transaction = http_request_transaction
+      set_current_transaction(transaction)
+      as.notifier = notifier
+
+      expect(perform).to eq "value"
+      expect(transaction).to include_event(
+        "body" => "",
+        "name" => "sql.active_record",
+        "title" => ""
+      )
+    end
+  end
+
   describe "an ActiveRecord SQL query event with a connection" do
     let(:connection) { double(:adapter_name => "PostgreSQL") }
 
@@ -415,6 +444,63 @@ shared_examples "activesupport instrument override" do
     end
   end
 
+  describe "an event whose formatter is registered after it was first recorded" do
+    after do
+      Appsignal::EventFormatter.unregister(
+        "later.example",
+        Appsignal::EventFormatter::RecordedElsewhere
+      )
+    end
+
+    def perform
+      as.instrument("later.example") { "value" }
+    end
+
+    it "in agent mode", :agent_mode do
+      start_agent
+      transaction = http_request_transaction
+      set_current_transaction(transaction)
+      as.notifier = notifier
+
+      perform
+      Appsignal::EventFormatter.register(
+        "later.example",
+        Appsignal::EventFormatter::RecordedElsewhere
+      )
+      perform
+
+      expect(transaction.to_h["events"]).to match(
+        [hash_including("name" => "later.example", "count" => 1)]
+      )
+    end
+  end
+
+  describe "without a current transaction" do
+    it "doesn't look up the event", :agent_mode do
+      start_agent
+      as.notifier = notifier
+      expect(Appsignal::Integrations::ActiveSupportNotificationsIntegration)
+        .to_not receive(:descriptor_for)
+      expect(Appsignal::EventFormatter).to_not receive(:formatter_for)
+
+      expect(as.instrument("sql.active_record", :sql => "SQL") { "value" }).to eq("value")
+    end
+  end
+
+  describe "with a paused transaction" do
+    it "doesn't record the event", :agent_mode do
+      start_agent
+      transaction = http_request_transaction
+      transaction.pause!
+      set_current_transaction(transaction)
+      as.notifier = notifier
+      expect(Appsignal::EventFormatter).to_not receive(:formatter_for)
+
+      expect(as.instrument("sql.active_record", :sql => "SQL") { "value" }).to eq("value")
+      expect(transaction.to_h["events"]).to be_empty
+    end
+  end
+
   describe "when an error is raised in an instrumented block" do
     def perform
       expect do
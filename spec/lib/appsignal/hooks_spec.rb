@@ -31,6 +31,34 @@ class MockErrorHook < Appsignal::Hooks::Hook
   end
 end
 
+class MockLazyHook < Appsignal::Hooks::Hook
+  install_when_defined "AppsignalLazyHookLibrary"
+
+  def dependencies_present?
+    defined?(::AppsignalLazyHookLibrary)
+  end
+
+  def install
+  end
+end
+
+class MockAutoloadHook < Appsignal::Hooks::Hook
+  install_when_defined "AppsignalAutoloadNamespace::Library"
+
+  def dependencies_present?
+    true
+  end
+
+  def install
+  end
+end
+
+class MockLazyErrorHook < MockLazyHook
+  def dependencies_present?
+    raise "error"
+  end
+end
+
 describe Appsignal::Hooks do
   it "should register and install a hook once" do
     Appsignal::Hooks::Hook.register(:mock_present_hook, MockPresentHook)
@@ -83,6 +111,110 @@ describe Appsignal::Hooks do
     expect(Appsignal::Hooks.hooks[:mock_error_hook].installed?).to be_falsy
     Appsignal::Hooks.hooks.delete(:mock_error_hook)
   end
+
+  it "doesn't wait for a require to install the GVL hook" do
+    # The gvltools gem is only loaded by the hook itself
+    expect(Appsignal::Hooks::GvlHook.new.pending?).to be_falsy
+  end
+
+  describe "a hook with a nested library constant" do
+    let(:hook) { MockAutoloadHook.new }
+
+    it "isn't pending once the library is loaded" do
+      stub_const("AppsignalAutoloadNamespace::Library", Module.new)
+
+      expect(hook.pending?).to be(false)
+    end
+
+    it "doesn't load the library when it's registered to be autoloaded" do
+      stub_const("AppsignalAutoloadNamespace", Module.new)
+      AppsignalAutoloadNamespace.autoload(:Library, "appsignal_nonexistent_library")
+
+      expect(hook.pending?).to be(true)
+    end
+
+    it "doesn't load a namespace that's registered to be autoloaded" do
+      Object.autoload(:AppsignalAutoloadNamespace, "appsignal_nonexistent_namespace")
+
+      expect(hook.pending?).to be(true)
+    ensure
+      Object.send(:remove_const, :AppsignalAutoloadNamespace)
+    end
+  end
+
+  context "with the enable_lazy_hooks config option" do
+    let(:hook) { MockLazyHook.new }
+    let(:library_path) { File.join(tmp_dir, "appsignal_lazy_hook_library.rb") }
+    before do
+      allow(Appsignal::Hooks).to receive(:hooks).and_return(:mock_lazy_hook => hook)
+      start_agent(:options => { :enable_lazy_hooks => true })
+    end
+    after do
+      Appsignal::Hooks.pending_hooks.clear
+      Object.send(:remove_const, :AppsignalLazyHookLibrary) if defined?(::AppsignalLazyHookLibrary)
+      $LOADED_FEATURES.delete(library_path)
+    end
+
+    it "installs the hook once a required file defines the library constant" do
+      expect(hook.installed?).to be_falsy
+      expect(Appsignal::Hooks.pending_hooks).to eq(:mock_lazy_hook => hook)
+
+      write_file(library_path, "module AppsignalLazyHookLibrary; end")
+      require library_path
+
+      expect(hook.installed?).to be_truthy
+      expect(Appsignal::Hooks.pending_hooks).to be_empty
+    end
+
+    it "installs the hook once Kernel.require defines the library constant" do
+      write_file(library_path, "module AppsignalLazyHookLibrary; end")
+      Kernel.require library_path
+
+      expect(hook.installed?).to be_truthy
+    end
+
+    it "installs the hook when the library constant is defined after start" do
+      expect(Appsignal::Hooks.watching_requires?).to be(true)
+
+      # Defined by a file that was required before, and not by the file
+      # that is required now
+      Object.const_set(:AppsignalLazyHookLibrary, Module.new)
+      expect(hook.installed?).to be_falsy
+      require "set"
+
+      expect(hook.installed?).to be_truthy
+      expect(Appsignal::Hooks.pending_hooks).to be_empty
+    end
+
+    it "stops watching requires once all pending hooks are installed" do
+      write_file(library_path, "module AppsignalLazyHookLibrary; end")
+      require library_path
+      expect(Appsignal::Hooks.watching_requires?).to be(false)
+
+      expect(Appsignal::Hooks).to_not receive(:watch_require)
+      require "set"
+      Kernel.require "set"
+    end
+
+    it "logs an error instead of failing the require when a hook raises" do
+      error_hook = MockLazyErrorHook.new
+      Appsignal::Hooks.pending_hooks[:mock_lazy_error_hook] = error_hook
+      expect(Appsignal.internal_logger).to receive(:error)
+        .with(start_with("Error while installing pending hooks: RuntimeError: error\n"))
+
+      write_file(library_path, "module AppsignalLazyHookLibrary; end")
+      expect(require(library_path)).to be(true)
+    end
+
+    it "installs the hook on start if the library constant is already defined" do
+      Appsignal::Hooks.pending_hooks.clear
+      Object.const_set(:AppsignalLazyHookLibrary, Module.new)
+      Appsignal::Hooks.load_hooks
+
+      expect(hook.installed?).to be_truthy
+      expect(Appsignal::Hooks.pending_hooks).to be_empty
+    end
+  end
 end
 
 describe Appsignal::Hooks::Helpers do
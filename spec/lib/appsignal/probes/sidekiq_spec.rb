@@ -8,6 +8,7 @@ describe Appsignal::Probes::SidekiqProbe do
     # `start_agent` is supplied by the `:agent_mode`/`:collector_mode` contexts
     # on each example, not here -- a hardcoded `start_agent` would boot the agent
     # in agent mode and clobber collector mode's collector-endpoint setup.
+    around { |example| Timecop.freeze(Time.utc(2024, 1, 1, 12)) { example.run } }
     before do
       # The probe will `require "sidekiq/api"` on initialize, which
       # as of 8.0.8 expects the `Sidekiq` module to provide a `loader`
@@ -29,6 +30,10 @@ describe Appsignal::Probes::SidekiqProbe do
           end
         end
 
+        def initialize
+          @queues = Sidekiq.client.queues
+        end
+
         def workers_size
           # First method called, so count it towards a call
           self.class.count_call
@@ -68,16 +73,65 @@ describe Appsignal::Probes::SidekiqProbe do
         def enqueued
           15
         end
+
+        def queues
+          @queues.transform_values(&:first)
+        end
       end
 
       class SidekiqQueue
-        Queue = Struct.new(:name, :size, :latency) # rubocop:disable Lint/StructNewOverride
+        def initialize(name)
+          @name = name
+        end
+
+        # Latency in seconds
+        def latency
+          enqueued_at = Sidekiq.client.queues.fetch(@name).last
+          enqueued_at ? Time.now.to_f - enqueued_at : 0.0
+        end
+      end
+
+      # A stand-in for the Redis connection Sidekiq yields, with the queues
+      # the probe reads the oldest job of. It counts the round trips to
+      # Redis: every command called on the connection directly, and every
+      # pipelined batch of commands.
+      class FakeSidekiqRedis
+        attr_reader :round_trips
+        # Queue names with their length and the time their oldest job was
+        # enqueued at.
+        attr_accessor :queues
+
+        def initialize
+          @round_trips = 0
+          @queues = {
+            "default" => [10, Time.now.to_f - 12],
+            "critical" => [1, Time.now.to_f - 2]
+          }
+        end
+
+        def pipelined
+          @round_trips += 1
+          pipeline = Pipeline.new(self)
+          yield pipeline
+          pipeline.replies
+        end
+
+        def lrange(key, _start, _stop)
+          enqueued_at = queues.fetch(key.delete_prefix("queue:")).last
+          enqueued_at ? [JSON.generate("class" => "MyJob", "enqueued_at" => enqueued_at)] : []
+        end
+
+        class Pipeline
+          attr_reader :replies
+
+          def initialize(redis)
+            @redis = redis
+            @replies = []
+          end
 
-        def self.all
-          [
-            Queue.new("default", 10, 12),
-            Queue.new("critical", 1, 2)
-          ]
+          def lrange(*args)
+            @replies << @redis.lrange(*args)
+          end
         end
       end
 
@@ -99,15 +153,20 @@ describe Appsignal::Probes::SidekiqProbe do
         end
 
         def self.redis
-          yield Client.new
+          yield client
+        end
+
+        def self.client
+          @client ||= Client.new
         end
 
-        class Client
+        class Client < FakeSidekiqRedis
           def config
             Config.new
           end
 
           def info
+            @round_trips += 1
             Sidekiq7Mock.redis_info_data
           end
         end
@@ -138,10 +197,14 @@ describe Appsignal::Probes::SidekiqProbe do
         end
 
         def self.redis
-          yield Client.new
+          yield client
         end
 
-        class Client
+        def self.client
+          @client ||= Client.new
+        end
+
+        class Client < FakeSidekiqRedis
           def connection
             { :host => "localhost" }
           end
@@ -156,10 +219,11 @@ describe Appsignal::Probes::SidekiqProbe do
       end
     end
     after do
-      Object.send(:remove_const, :SidekiqStats)
-      Object.send(:remove_const, :SidekiqQueue)
       Object.send(:remove_const, :Sidekiq6Mock)
       Object.send(:remove_const, :Sidekiq7Mock)
+      Object.send(:remove_const, :FakeSidekiqRedis)
+      Object.send(:remove_const, :SidekiqStats)
+      Object.send(:remove_const, :SidekiqQueue)
     end
 
     def with_sidekiq7!
@@ -259,6 +323,51 @@ describe Appsignal::Probes::SidekiqProbe do
         end
       end
 
+      describe "queue latencies" do
+        it "fetches the latencies of all queues in one round trip", :agent_mode do
+          start_agent
+          Sidekiq7Mock.client.queues = Array.new(50) { |i| ["queue_#{i}", [1, nil]] }.to_h
+          # The Redis info and the queue latencies
+          expect { probe.call }.to change { Sidekiq7Mock.client.round_trips }.by(2)
+        end
+
+        it "reports a latency of zero for empty queues", :agent_mode do
+          start_agent
+          Sidekiq7Mock.client.queues = { "default" => [0, nil] }
+          expect_gauge("queue_length", 0, :queue => "default")
+          expect_gauge("queue_latency", 0.0, :queue => "default")
+          probe.call
+        end
+
+        it "reports the latency of jobs enqueued with the time in seconds", :agent_mode do
+          start_agent
+          Sidekiq7Mock.client.queues = { "default" => [1, Time.now.to_f - 3] }
+          expect_gauge("queue_latency", 3_000.0, :queue => "default")
+          probe.call
+        end
+
+        it "reports the latency of jobs enqueued with the time in milliseconds", :agent_mode do
+          start_agent
+          # Sidekiq 8 stores the time as an Integer in milliseconds
+          enqueued_at = Process.clock_gettime(Process::CLOCK_REALTIME, :millisecond) - 3_000
+          Sidekiq7Mock.client.queues = { "default" => [1, enqueued_at] }
+          expect_gauge("queue_latency", be_within(50).of(3_000.0), :queue => "default")
+          probe.call
+        end
+
+        context "with a Sidekiq version of which the Redis layout is unknown" do
+          before { stub_const("Sidekiq7Mock::VERSION", "9.0.0") }
+
+          it "reads the latency of every queue with Sidekiq::Queue", :agent_mode do
+            start_agent
+            expect_gauge("queue_latency", 12_000, :queue => "default")
+            expect_gauge("queue_latency", 2_000, :queue => "critical")
+            # Only the Redis info
+            expect { probe.call }.to change { Sidekiq7Mock.client.round_trips }.by(1)
+          end
+        end
+      end
+
       context "when redis info doesn't contain requested keys" do
         before { Sidekiq7Mock.redis_info_data = {} }
 
@@ -411,6 +520,7 @@ describe Appsignal::Probes::SidekiqProbe do
       expect_gauge("queue_latency", 12_000, :queue => "default").twice
       expect_gauge("queue_length", 1, :queue => "critical").twice
       expect_gauge("queue_latency", 2_000, :queue => "critical").twice
+      expect_gauge("collection_duration", kind_of(Float)).twice
     end
 
     # The collector-mode counterpart of `expect_all_custom_gauges`: the agent
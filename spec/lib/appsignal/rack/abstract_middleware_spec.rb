@@ -87,6 +87,39 @@ describe Appsignal::Rack::AbstractMiddleware do
         expect(body).to be_kind_of(Appsignal::Rack::BodyWrapper)
       end
 
+      describe "streaming instrumentation" do
+        it "doesn't measure the response body stream by default", :agent_mode do
+          start_agent(**start_agent_args)
+          expect(Appsignal::Rack::BodyWrapper).to receive(:wrap)
+            .with(anything, anything, :instrument_streaming => false)
+            .and_call_original
+
+          make_request
+        end
+
+        it "reads the config option once per middleware", :agent_mode do
+          start_agent(
+            **start_agent_args,
+            :options => { :enable_rack_streaming_instrumentation => true }
+          )
+          expect(Appsignal::Rack::BodyWrapper).to receive(:wrap)
+            .with(anything, anything, :instrument_streaming => true)
+            .twice
+            .and_call_original
+          allow(Appsignal.config).to receive(:[]).and_call_original
+          expect(Appsignal.config).to receive(:[])
+            .with(:enable_rack_streaming_instrumentation)
+            .once
+            .and_call_original
+
+          2.times do
+            make_request
+            env.delete(Appsignal::Rack::APPSIGNAL_TRANSACTION)
+            env.delete(Appsignal::Rack::APPSIGNAL_RESPONSE_INSTRUMENTED)
+          end
+        end
+      end
+
       context "without an error" do
         it_in_both_modes "calls the next middleware in the stack" do
           make_request
@@ -485,6 +485,76 @@ describe Appsignal::Rack::BodyWrapper do
         expect_collector_no_error
       end
     end
+
+    describe "with streaming instrumentation" do
+      before do
+        start_agent
+        allow(Appsignal).to receive(:add_distribution_value)
+      end
+
+      it "reports the chunks, bytes and duration of the stream", :agent_mode do
+        fake_body = double
+        expect(fake_body).to receive(:each).once.and_yield("ab").and_yield("cde")
+
+        wrapped = described_class.wrap(fake_body, transaction, :instrument_streaming => true)
+        expect { |b| wrapped.each(&b) }.to yield_successive_args("ab", "cde")
+
+        expect(transaction).to include_metadata(
+          "response_body_chunks" => "2",
+          "response_body_bytes" => "5",
+          "response_body_duration_ms" => kind_of(String),
+          "response_body_iteration_first_chunk_ms" => kind_of(String)
+        )
+        tags = { :namespace => Appsignal::Transaction::HTTP_REQUEST }
+        expect(Appsignal).to have_received(:add_distribution_value)
+          .with("response_body_size", 5, tags)
+        expect(Appsignal).to have_received(:add_distribution_value)
+          .with("response_body_duration", kind_of(Float), tags)
+        expect(Appsignal).to have_received(:add_distribution_value)
+          .with("response_body_iteration_first_chunk", kind_of(Float), tags)
+      end
+
+      it "tags the metrics with the action of the transaction", :agent_mode do
+        transaction.set_action("HomeController#show")
+        wrapped =
+          described_class.wrap(double(:each => nil), transaction, :instrument_streaming => true)
+        wrapped.each { |_chunk| nil }
+
+        expect(Appsignal).to have_received(:add_distribution_value).with(
+          "response_body_size",
+          0,
+          :namespace => Appsignal::Transaction::HTTP_REQUEST,
+          :action => "HomeController#show"
+        )
+      end
+
+      it "doesn't report the first chunk time for an empty body", :agent_mode do
+        wrapped =
+          described_class.wrap(double(:each => nil), transaction, :instrument_streaming => true)
+        wrapped.each { |_chunk| nil }
+
+        expect(transaction).to include_metadata(
+          "response_body_chunks" => "0",
+          "response_body_bytes" => "0"
+        )
+        expect(transaction.to_h["metadata"])
+          .to_not have_key("response_body_iteration_first_chunk_ms")
+        expect(Appsignal).to_not have_received(:add_distribution_value)
+          .with("response_body_iteration_first_chunk", anything, anything)
+      end
+    end
+
+    it "doesn't measure the stream by default", :agent_mode do
+      start_agent
+
+      fake_body = double
+      expect(fake_body).to receive(:each).once.and_yield("ab")
+
+      wrapped = described_class.wrap(fake_body, transaction)
+      wrapped.each { |_chunk| nil }
+
+      expect(transaction.to_h["metadata"]).to_not have_key("response_body_chunks")
+    end
   end
 
   describe "with a body supporting both each() and call" do
@@ -1271,6 +1341,33 @@ describe Appsignal::Rack::BodyWrapper do
         expect_collector_no_error
       end
     end
+
+    describe "with streaming instrumentation" do
+      before do
+        start_agent
+        allow(Appsignal).to receive(:add_distribution_value)
+      end
+
+      it "reports the chunks and bytes written to the stream", :agent_mode do
+        fake_rack_stream = StringIO.new
+        expect(fake_body).to receive(:call) do |stream|
+          stream.write("ab", "c")
+          stream << "de"
+          stream.close_write
+        end
+
+        wrapped = described_class.wrap(fake_body, transaction, :instrument_streaming => true)
+        wrapped.call(fake_rack_stream)
+
+        expect(fake_rack_stream.string).to eq("abcde")
+        expect(transaction).to include_metadata(
+          "response_body_chunks" => "3",
+          "response_body_bytes" => "5"
+        )
+        expect(Appsignal).to have_received(:add_distribution_value)
+          .with("response_body_size", 5, :namespace => Appsignal::Transaction::HTTP_REQUEST)
+      end
+    end
   end
 
   def error_with_cause(klass, message, cause)
@@ -302,6 +302,51 @@ describe Appsignal::SampleData do
 
       expect(Appsignal::Testing.store[:block_call]).to eq(1)
     end
+
+    it "returns the same frozen value until more data is added" do
+      data.add(:key1 => "value 1")
+      value = data.value
+
+      expect(value).to be_frozen
+      expect(data.value).to equal(value)
+
+      data.add(:key2 => "value 2")
+      expect(data.value).to_not equal(value)
+      expect(data.value).to eq(:key1 => "value 1", :key2 => "value 2")
+    end
+
+    it "only calls the blocks added after the last calculated value" do
+      Appsignal::Testing.store[:block_calls] = []
+      data.add do
+        Appsignal::Testing.store[:block_calls] << :first
+        { :key1 => "value 1" }
+      end
+      data.value
+      data.add do
+        Appsignal::Testing.store[:block_calls] << :second
+        { :key2 => "value 2" }
+      end
+
+      expect(data.value).to eq(:key1 => "value 1", :key2 => "value 2")
+      expect(Appsignal::Testing.store[:block_calls]).to eq([:first, :second])
+    end
+
+    it "doesn't modify the added values" do
+      hash = { :key1 => "value 1" }
+      array = [:first]
+      data.add(hash)
+      data.add(:key2 => "value 2")
+      data.value
+      array_data = described_class.new(:array_key)
+      array_data.add(array)
+      array_data.add([:second])
+      array_data.value
+
+      expect(hash).to eq(:key1 => "value 1")
+      expect(hash).to_not be_frozen
+      expect(array).to eq([:first])
+      expect(array).to_not be_frozen
+    end
   end
 
   describe "#value?" do
@@ -387,5 +432,42 @@ describe Appsignal::SampleData do
       expect(duplicate.instance_variable_get(:@key)).to eq(:my_key)
       expect(duplicate.instance_variable_get(:@accepted_type)).to eq(Array)
     end
+
+    it "shares the calculated value with the duplicate" do
+      data = described_class.new(:my_key, Hash)
+      data.add { { :abc => :value } }
+      value = data.value
+
+      duplicate = data.dup
+
+      expect(duplicate.value).to equal(value)
+    end
+
+    it "shares the value calculated after duplication with the duplicate" do
+      calls = 0
+      data = described_class.new(:my_key, Hash)
+      data.add do
+        calls += 1
+        { :abc => :value }
+      end
+
+      duplicate = data.dup
+      expect(calls).to eq(0)
+
+      expect(duplicate.value).to eq(:abc => :value)
+      expect(data.value).to equal(duplicate.value)
+      expect(calls).to eq(1)
+    end
+
+    it "doesn't share the value with a duplicate that had data added" do
+      data = described_class.new(:my_key, Hash)
+      data.add { { :abc => :value } }
+
+      duplicate = data.dup
+      duplicate.add(:def => :value)
+
+      expect(duplicate.value).to eq(:abc => :value, :def => :value)
+      expect(data.value).to eq(:abc => :value)
+    end
   end
 end
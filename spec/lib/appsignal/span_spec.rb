@@ -34,6 +34,17 @@ describe Appsignal::Span do
     end
   end
 
+  describe "#child_with" do
+    let(:child) { root.child_with("Child name", :string => "attribute", "integer" => 1001) }
+
+    it "creates a child span with a name and attributes" do
+      expect(child.to_h["parent_span_id"]).to eq root.to_h["span_id"]
+      expect(child.to_h["name"]).to eq "Child name"
+      expect(child.to_h["attributes"]).to eq("string" => "attribute", "integer" => 1001)
+      expect(child.to_h["closed"]).to be false
+    end
+  end
+
   describe "#add_error" do
     it "adds an error" do
       begin
@@ -108,6 +119,38 @@ describe Appsignal::Span do
     end
   end
 
+  describe "#set_attributes" do
+    let(:attributes) { root.to_h["attributes"] }
+
+    it "sets attributes of every supported type" do
+      root.set_attributes(
+        "string" => "attribute",
+        :symbol_key => "attribute",
+        "integer" => 1001,
+        "bigint" => 1 << 64,
+        "true" => true,
+        "false" => false,
+        "float" => 10.01
+      )
+
+      expect(attributes).to eq(
+        "string" => "attribute",
+        "symbol_key" => "attribute",
+        "integer" => 1001,
+        "bigint" => "bigint:#{1 << 64}",
+        "true" => true,
+        "false" => false,
+        "float" => 10.01
+      )
+    end
+
+    it "raises an error for other types" do
+      expect do
+        root.set_attributes("something" => Object.new)
+      end.to raise_error TypeError
+    end
+  end
+
   describe "#instrument" do
     it "closes the span after yielding" do
       root.instrument do
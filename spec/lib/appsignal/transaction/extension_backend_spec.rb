@@ -108,7 +108,8 @@ describe Appsignal::Transaction::ExtensionBackend do
     it "serializes the sample data to Data and forwards #set_sample_data to the handle" do
       raw = { "a" => 1 }
       data = Appsignal::Utils::Data.generate(raw)
-      expect(Appsignal::Utils::Data).to receive(:generate).with(raw).and_return(data)
+      expect(Appsignal::Utils::Data).to receive(:generate)
+        .with(raw, an_instance_of(Appsignal::Utils::Data::Budget)).and_return(data)
       expect(handle).to receive(:set_sample_data).with("params", data)
       backend.set_sample_data("params", raw)
     end
@@ -172,6 +173,47 @@ describe Appsignal::Transaction::ExtensionBackend do
     end
   end
 
+  describe "sample data limits" do
+    let(:handle) { backend.instance_variable_get(:@handle) }
+
+    it "truncates sample data that is bigger than the per key limit" do
+      stub_const("Appsignal::Transaction::SAMPLE_DATA_KEY_BYTES_LIMIT", 10)
+      expect(handle).to receive(:set_sample_data).with(
+        "params",
+        Appsignal::Utils::Data.generate("a" => "b", "c" => "[TRUNCATED]")
+      )
+
+      backend.set_sample_data("params", "a" => "b", "c" => "x" * 20, "d" => "e")
+    end
+
+    it "truncates sample data once the per transaction limit is spent" do
+      stub_const("Appsignal::Transaction::SAMPLE_DATA_BYTES_LIMIT", 10)
+      expect(handle).to receive(:set_sample_data)
+        .with("params", Appsignal::Utils::Data.generate("abc" => "def"))
+      expect(handle).to receive(:set_sample_data)
+        .with("custom_data", Appsignal::Utils::Data.generate("abc" => "[TRUNCATED]"))
+
+      backend.set_sample_data("params", "abc" => "def")
+      backend.set_sample_data("custom_data", "abc" => "def")
+    end
+
+    it "increments the truncated transactions counter on complete" do
+      stub_const("Appsignal::Transaction::SAMPLE_DATA_KEY_BYTES_LIMIT", 10)
+      backend.set_sample_data("params", "abc" => "x" * 20)
+
+      expect(Appsignal::Extension).to receive(:increment_counter)
+        .with("appsignal_truncated_transactions", 1.0, Appsignal::Utils::Data.generate({}))
+      backend.complete
+    end
+
+    it "does not increment the truncated transactions counter when nothing was truncated" do
+      backend.set_sample_data("params", "abc" => "def")
+
+      expect(Appsignal::Extension).to_not receive(:increment_counter)
+      backend.complete
+    end
+  end
+
   describe "breadcrumbs" do
     let(:handle) { backend.instance_variable_get(:@handle) }
 
@@ -188,7 +230,8 @@ describe Appsignal::Transaction::ExtensionBackend do
       backend.add_breadcrumb(:action => "click")
       data = Appsignal::Utils::Data.generate([{ :action => "click" }])
       expect(Appsignal::Utils::Data).to receive(:generate)
-        .with([{ :action => "click" }]).and_return(data)
+        .with([{ :action => "click" }], an_instance_of(Appsignal::Utils::Data::Budget))
+        .and_return(data)
       expect(handle).to receive(:set_sample_data).with("breadcrumbs", data)
       expect(handle).to receive(:complete)
 
@@ -239,8 +282,36 @@ describe Appsignal::Transaction::ExtensionBackend do
   end
 
   describe "#supports_multiple_errors?" do
-    it "returns false (extra errors are reported as duplicate transactions)" do
+    let(:handle) { double(:set_error => nil, :set_sample_data => nil) }
+    let(:backend) { described_class.new("abc-123", "web", :handle => handle) }
+
+    it "returns false when the extension transaction holds a single error" do
       expect(backend.supports_multiple_errors?).to eq(false)
     end
+
+    context "when the extension transaction can hold multiple errors" do
+      before { allow(handle).to receive(:add_error) }
+
+      it "returns true" do
+        expect(backend.supports_multiple_errors?).to eq(true)
+      end
+
+      it "adds the errors after the first one to the same extension transaction" do
+        causes = [{ :name => "ArgumentError", :message => "bad arg", :backtrace => nil }]
+        expect(handle).to receive(:set_error)
+          .with("RuntimeError", "first", Appsignal::Utils::Data.generate(["line 1"])).once
+        expect(handle).to receive(:add_error).with(
+          "StandardError",
+          "second",
+          Appsignal::Utils::Data.generate(["line 2"]),
+          Appsignal::Utils::Data.generate(
+            [{ "name" => "ArgumentError", "message" => "bad arg", "first_line" => nil }]
+          )
+        )
+
+        backend.set_error("RuntimeError", "first", ["line 1"], [], false)
+        backend.set_error("StandardError", "second", ["line 2"], causes, false)
+      end
+    end
   end
 end
@@ -405,6 +405,10 @@ describe Appsignal::Transaction do
         expect(current_transaction).to be_a(Appsignal::Transaction::NilTransaction)
       end
 
+      it "returns the same NilTransaction stub every time" do
+        expect(current_transaction).to equal(Appsignal::Transaction.current)
+      end
+
       it "returns false for current?" do
         expect(Appsignal::Transaction.current?).to be(false)
       end
@@ -488,6 +492,115 @@ describe Appsignal::Transaction do
       end
     end
 
+    context "with overhead accounting enabled", :agent_mode do
+      let(:options) { { :enable_overhead_accounting => true } }
+      before { start_agent(**start_agent_args) }
+
+      it "reports the overhead of the transaction per part" do
+        allow(Appsignal).to receive(:add_distribution_value).and_call_original
+        transaction.add_params(:id => 1)
+        transaction.start_event
+        transaction.finish_event("sql.active_record", "title", "body")
+        transaction.complete
+
+        [
+          "extension.finish_event",
+          "extension.set_sample_data",
+          "extension.complete",
+          "transaction.complete",
+          "transaction.sample_data"
+        ].each do |part|
+          expect(Appsignal).to have_received(:add_distribution_value)
+            .with("appsignal_overhead", kind_of(Float), :part => part, :namespace => default_namespace)
+        end
+      end
+
+      it "does not report the overhead of duplicate transactions" do
+        allow(Appsignal).to receive(:add_distribution_value).and_call_original
+        transaction.add_error(ExampleException.new("error 1"))
+        transaction.add_error(ExampleException.new("error 2"))
+        transaction.complete
+
+        expect(Appsignal).to have_received(:add_distribution_value)
+          .with("appsignal_overhead", anything, hash_including(:part => "transaction.complete"))
+          .once
+      end
+    end
+
+    context "with overhead accounting disabled" do
+      it "does not report the overhead of the transaction" do
+        allow(Appsignal).to receive(:add_distribution_value).and_call_original
+        transaction.complete
+
+        expect(Appsignal).to_not have_received(:add_distribution_value)
+          .with("appsignal_overhead", any_args)
+      end
+    end
+
+    context "with action histograms enabled", :agent_mode do
+      let(:options) { { :enable_action_histograms => true, :hostname => "my-host" } }
+      before do
+        start_agent(**start_agent_args)
+        Appsignal::Extension.reset_action_histograms
+      end
+
+      def report_action_histograms
+        allow(Appsignal).to receive(:set_gauge).and_call_original
+        Appsignal::ActionHistograms.report(:include_current => true)
+      end
+
+      it "reports the duration percentiles per action" do
+        transaction.set_action("MyController#show")
+        transaction.complete
+        report_action_histograms
+
+        tags = {
+          :namespace => default_namespace,
+          :action => "MyController#show",
+          :hostname => "my-host"
+        }
+        expect(Appsignal).to have_received(:set_gauge)
+          .with("transaction_duration_count", 1, tags)
+        ["p50", "p95", "p99", "max"].each do |percentile|
+          expect(Appsignal).to have_received(:set_gauge).with(
+            "transaction_duration_percentile",
+            kind_of(Float),
+            tags.merge(:percentile => percentile)
+          )
+        end
+      end
+
+      it "does not report the durations when completing the transaction" do
+        allow(Appsignal::Extension).to receive(:record_action_duration).and_call_original
+        allow(Appsignal::Extension).to receive(:action_histograms).and_call_original
+        allow(Appsignal).to receive(:set_gauge).and_call_original
+        transaction.set_action("MyController#show")
+        transaction.complete
+
+        expect(Appsignal::Extension).to have_received(:record_action_duration)
+        expect(Appsignal::Extension).to_not have_received(:action_histograms)
+        expect(Appsignal).to_not have_received(:set_gauge)
+      end
+
+      it "does not count transactions without an action" do
+        transaction.complete
+        report_action_histograms
+
+        expect(Appsignal).to_not have_received(:set_gauge)
+      end
+
+      it "does not count duplicate transactions" do
+        transaction.set_action("MyController#show")
+        transaction.add_error(ExampleException.new("error 1"))
+        transaction.add_error(ExampleException.new("error 2"))
+        transaction.complete
+        report_action_histograms
+
+        expect(Appsignal).to have_received(:set_gauge)
+          .with("transaction_duration_count", 1, hash_including(:action => "MyController#show"))
+      end
+    end
+
     context "when a transaction is marked as discarded" do
       it "marks the transaction as discarded" do
         expect do
@@ -816,6 +929,46 @@ describe Appsignal::Transaction do
         expect(duplicate_transaction).to_not include_breadcrumb("breadcrumb", "original")
       end
 
+      it "calculates the sample data once for the original and duplicate transactions" do
+        Appsignal::Testing.store[:params_block_calls] = 0
+        transaction.add_params do
+          Appsignal::Testing.store[:params_block_calls] += 1
+          { "key" => "value" }
+        end
+        transaction.add_error(error)
+        transaction.add_error(other_error)
+        transaction.add_error(ExampleStandardError.new("third error"))
+        transaction.complete
+
+        expect(created_transactions.count).to eq(3)
+        created_transactions.each do |t|
+          expect(t).to include_params("key" => "value")
+        end
+        expect(Appsignal::Testing.store[:params_block_calls]).to eq(1)
+      end
+
+      context "when params and session data are not sent" do
+        let(:options) { { :send_params => false, :send_session_data => false } }
+
+        it "doesn't call the params and session data blocks" do
+          Appsignal::Testing.store[:sample_data_block_calls] = 0
+          transaction.add_params do
+            Appsignal::Testing.store[:sample_data_block_calls] += 1
+            { "key" => "value" }
+          end
+          transaction.add_session_data do
+            Appsignal::Testing.store[:sample_data_block_calls] += 1
+            { "key" => "value" }
+          end
+          transaction.add_error(error)
+          transaction.add_error(other_error)
+          transaction.complete
+
+          expect(created_transactions.count).to eq(2)
+          expect(Appsignal::Testing.store[:sample_data_block_calls]).to eq(0)
+        end
+      end
+
       it "overrides sample data from the original transaction in the duplicate transaction" do
         transaction.add_tags("changeme" => "tag")
         transaction.add_params("changeme" => "param")
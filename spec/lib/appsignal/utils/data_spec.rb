@@ -177,6 +177,60 @@ describe Appsignal::Utils::Data do
         end
       end
 
+      context "with a budget" do
+        def generate_with_budget(object, max_bytes: 1024, max_depth: 10)
+          budget = Appsignal::Utils::Data::Budget.new(max_bytes, max_depth)
+          [Appsignal::Utils::Data.generate(object, budget), budget]
+        end
+
+        it "writes the full body when it fits in the budget" do
+          value, budget = generate_with_budget("abc" => "def", "ghi" => [1, nil])
+
+          expect(value.to_s).to eq(%({"abc":"def","ghi":[1,null]}))
+          expect(budget.bytes_used).to eq(33)
+          expect(budget).to_not be_truncated
+        end
+
+        it "stops the walk and inserts a marker when the bytes run out" do
+          value, budget = generate_with_budget(
+            { "a" => "b", "c" => "x" * 100, "d" => "e" },
+            :max_bytes => 10
+          )
+
+          expect(value.to_s).to eq(%({"a":"b","c":"[TRUNCATED]"}))
+          expect(budget).to be_truncated
+          expect(budget).to be_exhausted
+        end
+
+        it "stops the walk of the enclosing Hashes and Arrays" do
+          value, budget = generate_with_budget(
+            ["a", ["b", "x" * 100, "c"], "d"],
+            :max_bytes => 10
+          )
+
+          expect(value.to_s).to eq(%(["a",["b","[TRUNCATED]"]]))
+          expect(budget).to be_truncated
+        end
+
+        it "replaces values that are nested too deeply with a marker" do
+          value, budget = generate_with_budget(
+            { "a" => { "b" => { "c" => "d" } }, "e" => "f" },
+            :max_depth => 2
+          )
+
+          expect(value.to_s).to eq(%({"a":{"b":"[TRUNCATED]"},"e":"f"}))
+          expect(budget).to be_truncated
+          expect(budget).to_not be_exhausted
+        end
+
+        it "counts other objects by the size of their String representation" do
+          value, budget = generate_with_budget([:abcdef])
+
+          expect(value.to_s).to eq(%(["abcdef"]))
+          expect(budget.bytes_used).to eq(6)
+        end
+      end
+
       context "with a body that contains strings with invalid utf-8 content" do
         describe "#to_s" do
           it "returns a JSON representation in a String" do
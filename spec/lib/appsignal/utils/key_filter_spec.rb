@@ -0,0 +1,31 @@
+describe Appsignal::Utils::KeyFilter do
+  let(:filter) { described_class.new(["password", :token]) }
+
+  it "matches String keys" do
+    expect(filter.include?("password")).to be(true)
+    expect(filter.include?("token")).to be(true)
+    expect(filter.include?("email")).to be(false)
+  end
+
+  it "matches Symbol keys" do
+    expect(filter.include?(:password)).to be(true)
+    expect(filter.include?(:token)).to be(true)
+    expect(filter.include?(:email)).to be(false)
+  end
+
+  it "matches other keys by their String form" do
+    expect(described_class.new(["1"]).include?(1)).to be(true)
+    expect(filter.include?(1)).to be(false)
+  end
+
+  it "doesn't match anything without keys" do
+    filter = described_class.new([])
+
+    expect(filter).to be_empty
+    expect(filter.include?("password")).to be(false)
+  end
+
+  it "is frozen" do
+    expect(filter).to be_frozen
+  end
+end
@@ -189,4 +189,105 @@ describe Appsignal::Utils::QueryParamsSanitizer do
       end
     end
   end
+
+  describe "frozen results" do
+    it "returns a frozen result without the shape from the extension" do
+      allow(Appsignal::Extension).to receive(:query_params_shape).and_return(nil)
+      result = described_class.sanitize("a" => { "b" => [1] })
+
+      expect(result).to eq("a" => { "b" => ["?"] })
+      expect(result).to be_frozen
+      expect(result["a"]).to be_frozen
+      expect(result["a"]["b"]).to be_frozen
+    end
+
+    it "returns a frozen result with the shape from the extension",
+      :skip => DependencyHelper.running_jruby? do
+      described_class.clear_cache!
+      result = described_class.sanitize("a" => { "b" => [1] })
+
+      expect(result).to eq("a" => { "b" => ["?"] })
+      expect(result).to be_frozen
+      expect(result["a"]).to be_frozen
+      expect(result["a"]["b"]).to be_frozen
+    end
+  end
+
+  unless DependencyHelper.running_jruby?
+    describe "caching by shape" do
+      before { described_class.clear_cache! }
+
+      it "returns the cached frozen result for queries with the same shape" do
+        first =
+          described_class.sanitize("find" => "users", "filter" => { "id" => 1, "tags" => [1, 2] })
+        second =
+          described_class.sanitize("find" => "posts", "filter" => { "id" => 2, "tags" => [3] })
+
+        expect(first).to eq("find" => "?", "filter" => { "id" => "?", "tags" => ["?"] })
+        expect(second).to equal(first)
+        expect(second).to be_frozen
+        expect(second["filter"]).to be_frozen
+        expect(second["filter"]["tags"]).to be_frozen
+      end
+
+      it "doesn't share results between different shapes" do
+        expect(described_class.sanitize("id" => 1)).to eq("id" => "?")
+        expect(described_class.sanitize(:id => 1)).to eq(:id => "?")
+        expect(described_class.sanitize("id" => { "$in" => [1] })).to eq("id" => { "$in" => ["?"] })
+        expect(described_class.sanitize([1, { "id" => 1 }])).to eq(["?", { "id" => "?" }])
+        expect(described_class.sanitize([{ "id" => 1 }, 1])).to eq([{ "id" => "?" }, "?"])
+        expect(described_class.sanitize({ "id" => { "a" => 1 } }, true)).to eq("id" => "?")
+        expect(described_class.sanitize("id.key" => 1)).to eq("id.key" => "?")
+        expect(described_class.sanitize({ "id.key" => 1 }, false, :mongodb)).to eq("id.?" => "?")
+      end
+
+      it "doesn't share results between keys that run together" do
+        expect(described_class.sanitize("ab" => { "c" => 1 })).to eq("ab" => { "c" => "?" })
+        expect(described_class.sanitize("a" => { "bc" => 1 })).to eq("a" => { "bc" => "?" })
+        expect(described_class.sanitize("a" => 1, "b" => 1)).to eq("a" => "?", "b" => "?")
+      end
+
+      it "caches the result by the full shape of the query" do
+        shape = Appsignal::Extension.query_params_shape({ "a" => [1, 2] }, false, false)
+
+        expect(shape).to be_frozen
+        expect(Appsignal::Extension.query_params_shape({ "a" => [3] }, false, false))
+          .to eq(shape)
+        expect(Appsignal::Extension.query_params_shape({ "b" => [3] }, false, false))
+          .to_not eq(shape)
+      end
+
+      it "doesn't cache queries with keys other than Strings and Symbols" do
+        first = described_class.sanitize(1 => "value")
+        second = described_class.sanitize(1 => "value")
+
+        expect(second).to eq(1 => "?")
+        expect(second).to_not equal(first)
+        expect(second).to be_frozen
+      end
+
+      it "returns a frozen result for a query sanitized again after its shape was removed" do
+        stub_const("#{described_class}::CACHE_LIMIT", 1)
+        first = described_class.sanitize("a" => { "b" => [1] })
+        described_class.sanitize("c" => 1)
+        second = described_class.sanitize("a" => { "b" => [1] })
+
+        expect(second).to_not equal(first)
+        expect(second).to be_frozen
+        expect(second["a"]).to be_frozen
+        expect(second["a"]["b"]).to be_frozen
+      end
+
+      it "removes the least recently used shape when the cache is full" do
+        stub_const("#{described_class}::CACHE_LIMIT", 2)
+        first = described_class.sanitize("a" => 1)
+        described_class.sanitize("b" => 1)
+        described_class.sanitize("a" => 1)
+        described_class.sanitize("c" => 1)
+
+        expect(described_class.sanitize("a" => 1)).to equal(first)
+        expect(described_class.sanitize("b" => 1)).to_not equal(first)
+      end
+    end
+  end
 end
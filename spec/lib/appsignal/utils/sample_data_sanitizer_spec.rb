@@ -149,6 +149,13 @@ describe Appsignal::Utils::SampleDataSanitizer do
           .to eq(:user => { :password => "[FILTERED]", :id => 123 })
       end
 
+      it "sanitizes values with a KeyFilter" do
+        object = { :password => "secret", "email" => "my email", :user_id => 123 }
+        filter = Appsignal::Utils::KeyFilter.new(["password", "email"])
+        expect(sanitize(object, filter))
+          .to eq(:password => "[FILTERED]", "email" => "[FILTERED]", :user_id => 123)
+      end
+
       it "sanitizes multiple values" do
         object = { :password => "secret", :email => "my email", :user_id => 123 }
         expect(sanitize(object, ["password", "email"]))
@@ -185,5 +192,46 @@ describe Appsignal::Utils::SampleDataSanitizer do
         end.to_not(change { password })
       end
     end
+
+    context "with a budget" do
+      def sanitize_with_budget(value, max_bytes: 1024, max_depth: 10)
+        budget = Appsignal::Utils::Data::Budget.new(max_bytes, max_depth)
+        [described_class.sanitize(value, [], budget), budget]
+      end
+
+      it "doesn't change values that fit in the budget" do
+        value, budget = sanitize_with_budget("a" => "b", "c" => [1, nil])
+
+        expect(value).to eq("a" => "b", "c" => [1, nil])
+        expect(budget).to_not be_exhausted
+      end
+
+      it "stops the walk and inserts a marker when the bytes run out" do
+        value, budget = sanitize_with_budget(
+          { "a" => "b", "c" => ["d", "x" * 100, "e"], "f" => "g" },
+          :max_bytes => 12
+        )
+
+        expect(value).to eq("a" => "b", "c" => ["d", "[TRUNCATED]"])
+        expect(budget).to be_exhausted
+      end
+
+      it "replaces values that are nested too deeply with a marker" do
+        value, = sanitize_with_budget(
+          { "a" => { "b" => { "c" => "d" } }, "e" => "f" },
+          :max_depth => 2
+        )
+
+        expect(value).to eq("a" => { "b" => "[TRUNCATED]" }, "e" => "f")
+      end
+
+      it "marks the budget of the serialized value as truncated" do
+        value, = sanitize_with_budget(["x" * 100], :max_bytes => 10)
+        budget = Appsignal::Utils::Data::Budget.new(1024, 10)
+        Appsignal::Utils::Data.generate(value, budget)
+
+        expect(budget).to be_truncated
+      end
+    end
   end
 end
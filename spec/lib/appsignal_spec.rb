@@ -915,6 +915,42 @@ describe Appsignal do
     end
   end
 
+  describe ".prefork" do
+    context "when not active" do
+      it "does nothing" do
+        expect(Appsignal::Hooks).to_not receive(:prefork)
+
+        expect(Appsignal.prefork).to be_nil
+      end
+    end
+
+    context "when active" do
+      before do
+        Appsignal.configure(:production, :root_path => project_fixture_path)
+        Appsignal.start
+      end
+
+      it "builds the state shared with forked processes" do
+        expect(Appsignal::Hooks).to receive(:prefork).and_call_original
+        expect(Appsignal::EventFormatter).to receive(:prefork).and_call_original
+        expect(Appsignal::Utils::QueryParamsSanitizer).to receive(:prefork).and_call_original
+        expect(Appsignal::Transaction).to receive(:prefork).and_call_original
+
+        expect(Appsignal.prefork).to be_nil
+      end
+
+      it "creates the transaction hook lists" do
+        Appsignal::Transaction.instance_variable_set(:@after_create, nil)
+        Appsignal::Transaction.instance_variable_set(:@before_complete, nil)
+
+        Appsignal.prefork
+
+        expect(Appsignal::Transaction.instance_variable_get(:@after_create)).to be_a(Set)
+        expect(Appsignal::Transaction.instance_variable_get(:@before_complete)).to be_a(Set)
+      end
+    end
+  end
+
   describe ".forked" do
     context "when not active" do
       it "does nothing" do
@@ -952,6 +988,16 @@ describe Appsignal do
 
         Appsignal.forked
       end
+
+      it "starts a new check-in scheduler" do
+        allow(Appsignal).to receive(:_start_logger)
+        allow(Appsignal::Extension).to receive(:start)
+        scheduler = Appsignal::CheckIn.scheduler
+
+        Appsignal.forked
+
+        expect(Appsignal::CheckIn.scheduler).to_not equal(scheduler)
+      end
     end
   end
 
@@ -198,6 +198,7 @@ RSpec.configure do |config|
 
   config.after do
     stop_minutely_probes
+    Appsignal::ActionHistograms.stop
   end
 
   config.after :context do